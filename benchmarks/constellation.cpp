@@ -0,0 +1,74 @@
+/*****************************************************************************\
+ * constellation.cpp
+ *
+ * Constellation of a million random J2000 positions: building a
+ * PrecessionMatrix to 1875 and searching the boundaries for each one (what
+ * callers had to do), against Constellation::classifyAtEpoch() one position at a
+ * time, in a single threaded batch and in a batch on every hardware thread.
+ *
+\*****************************************************************************/
+
+#include "hypatia/Constellation.h"
+#include "hypatia/CoordOps.h"
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+static const int SAMPLES = 1000000;
+
+template<class F>
+static double timeIt( F _f ) {
+    auto start = std::chrono::steady_clock::now();
+    _f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void report( const char* _name, double _ms, double _base, const std::vector<int>& _ids, const std::vector<int>& _expected ) {
+    int mismatches = 0;
+    for (size_t i = 0; i < _ids.size(); i++)
+        if (_ids[i] != _expected[i])
+            mismatches++;
+    printf("  %-32s %9.1f ms  %7.1f ns/point  (x%.1f)  mismatches %d\n", _name, _ms, _ms * 1e6 / SAMPLES, _base / _ms, mismatches);
+}
+
+int main() {
+    // uniform over the sphere
+    std::mt19937_64 random(1875);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<double> ra(SAMPLES), dec(SAMPLES);
+    for (int i = 0; i < SAMPLES; i++) {
+        ra[i] = (uniform(random) + 1.0) * 180.0;
+        dec[i] = MathOps::toDegrees( asin(uniform(random)) );
+    }
+
+    printf("%d random J2000 positions\n", SAMPLES);
+
+    std::vector<int> expected(SAMPLES);
+    double tBase = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++) {
+            PrecessionMatrix matrix(Constellation::EPOCH, 2000.0);
+            Equatorial position = CoordOps::precess(matrix, Equatorial(ra[i], dec[i], DEGS));
+            expected[i] = Constellation( MathOps::normalize(position.getRightAscension(DEGS), DEGS), position.getDeclination(DEGS) ).getId();
+        }
+    });
+    report("precess + search", tBase, tBase, expected, expected);
+
+    std::vector<int> ids(SAMPLES);
+    double t = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            ids[i] = Constellation::classifyAtEpoch( Equatorial(ra[i], dec[i], DEGS), 2000.0 );
+    });
+    report("classifyAtEpoch, one at a time", t, tBase, ids, expected);
+
+    t = timeIt([&]() { ids = Constellation::classifyAtEpoch(ra, dec, 2000.0, 1); });
+    report("classifyAtEpoch, batch", t, tBase, ids, expected);
+
+    t = timeIt([&]() { ids = Constellation::classifyAtEpoch(ra, dec, 2000.0); });
+    report("classifyAtEpoch, batch threaded", t, tBase, ids, expected);
+
+    return 0;
+}
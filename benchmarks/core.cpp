@@ -0,0 +1,106 @@
+/*****************************************************************************\
+ * core.cpp
+ *
+ * Compares the virtual Vector3 / Matrix3x3 / Ecliptic classes against the
+ * plain value types of Core.h on the same arithmetic: array updates,
+ * precession of star vectors and geocentric to heliocentric conversions.
+ *
+\*****************************************************************************/
+
+#include "hypatia/coordinates/Ecliptic.h"
+#include "hypatia/coordinates/PrecessionMatrix.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static const int SAMPLES = 100000;
+static const int ROUNDS = 20;
+
+template<class F>
+static double timeIt( F _f ) {
+    _f();   // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++)
+        _f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(ROUNDS) * SAMPLES);
+}
+
+static void report( const char* _name, double _classes, double _core, double _diff ) {
+    printf("  %-28s %8.2f ns  %8.2f ns  (x%.2f)  max difference %.1e\n", _name, _classes, _core, _classes / _core, _diff);
+}
+
+int main() {
+    std::vector<Vector3> a, b, outA;
+    std::vector<hypatia::vec3> ca, cb, outC;
+    std::vector<Ecliptic> geo;
+    for (int i = 0; i < SAMPLES; i++) {
+        double lng = fmod(i * 0.61803398875, MathOps::TAU);
+        double lat = sin(i * 0.001) * 1.2;
+        double rad = 0.5 + fmod(i * 0.1234, 30.0);
+        geo.push_back( Ecliptic(lng, lat, rad, RADS, AU) );
+        a.push_back( geo.back().getVector(AU) );
+        b.push_back( Vector3(cos(i * 0.3), sin(i * 0.7), 0.25) );
+        ca.push_back( a.back().getCore() );
+        cb.push_back( b.back().getCore() );
+    }
+    outA.resize(SAMPLES);
+    outC.resize(SAMPLES);
+
+    printf("%d samples, time per element\n", SAMPLES);
+    printf("  %-28s %11s  %11s\n", "", "classes", "core");
+
+    // plain arithmetic: out = a * k + b - a / k
+    const double k = 1.0000001;
+    double tClasses = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            outA[i] = a[i] * k + b[i] - a[i] / k;
+    });
+    double tCore = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            outC[i] = ca[i] * k + cb[i] - ca[i] / k;
+    });
+    double diff = 0.0;
+    for (int i = 0; i < SAMPLES; i++)
+        diff = fmax(diff, hypatia::length(outA[i].getCore() - outC[i]));
+    report("a * k + b - a / k", tClasses, tCore, diff);
+
+    // precession of unit vectors, J2000 to 2050
+    PrecessionMatrix matrix(2050.0);
+    const hypatia::mat3 m = matrix.getCore();
+    tClasses = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            outA[i] = matrix.precess(b[i]);
+    });
+    tCore = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            outC[i] = hypatia::mulTransposed(m, cb[i]);
+    });
+    diff = 0.0;
+    for (int i = 0; i < SAMPLES; i++)
+        diff = fmax(diff, hypatia::length(outA[i].getCore() - outC[i]));
+    report("precess", tClasses, tCore, diff);
+
+    // geocentric ecliptic to heliocentric, as CoordOps::toHeliocentric() did before the core
+    const Vector3 earth(0.98, 0.17, 0.0001);
+    const hypatia::vec3 earthCore = earth.getCore();
+    std::vector<Ecliptic> helioA(SAMPLES), helioC(SAMPLES);
+    tClasses = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            helioA[i] = Ecliptic(earth + Vector3(geo[i]) * geo[i].getRadius(AU), AU);
+    });
+    tCore = timeIt([&]() {
+        for (int i = 0; i < SAMPLES; i++)
+            helioC[i] = Ecliptic( hypatia::toEcliptic(earthCore + hypatia::toVector(geo[i].getCore())) );
+    });
+    diff = 0.0;
+    for (int i = 0; i < SAMPLES; i++) {
+        diff = fmax(diff, fabs(helioA[i].getLongitude(RADS) - helioC[i].getLongitude(RADS)));
+        diff = fmax(diff, fabs(helioA[i].getRadius(AU) - helioC[i].getRadius(AU)));
+    }
+    report("toHeliocentric", tClasses, tCore, diff);
+
+    return 0;
+}
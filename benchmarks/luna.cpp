@@ -0,0 +1,56 @@
+/*****************************************************************************\
+ * luna.cpp
+ *
+ * Compares the two ways of evaluating the lunar ELP2000-82 series:
+ * one sin()/cos() per term (Luna::DIRECT) against multiple angle tables
+ * (Luna::MULTIPLE_ANGLE).
+ *
+\*****************************************************************************/
+
+#include "hypatia/Luna.h"
+#include "hypatia/TimeOps.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+static const int    SAMPLES = 200000;
+static const double JD_START = 2451545.0;   // J2000
+static const double JD_STEP = 0.0137;       // days, about 7 years in total
+
+static double run( Luna::Evaluation _evaluation, double* _lng, double* _rad ) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; i++) {
+        Ecliptic geo = Luna::computeGeocentric( TimeOps::toJC(JD_START + i * JD_STEP), _evaluation );
+        _lng[i] = geo.getLongitude(RADS);
+        _rad[i] = geo.getRadius(KM);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / SAMPLES;
+}
+
+int main() {
+    static double lngDirect[SAMPLES], radDirect[SAMPLES];
+    static double lngTables[SAMPLES], radTables[SAMPLES];
+
+    // warm up
+    run( Luna::DIRECT, lngDirect, radDirect );
+
+    double direct = run( Luna::DIRECT, lngDirect, radDirect );
+    double tables = run( Luna::MULTIPLE_ANGLE, lngTables, radTables );
+
+    double dLng = 0.0, dRad = 0.0;
+    for (int i = 0; i < SAMPLES; i++) {
+        double d = fabs( lngDirect[i] - lngTables[i] );
+        if (d > MathOps::PI)
+            d = MathOps::TAU - d;
+        dLng = fmax( dLng, d );
+        dRad = fmax( dRad, fabs( radDirect[i] - radTables[i] ) );
+    }
+
+    printf("Luna::computeGeocentric() over %d epochs\n", SAMPLES);
+    printf("  DIRECT          %8.1f ns/call\n", direct);
+    printf("  MULTIPLE_ANGLE  %8.1f ns/call  (x%.2f)\n", tables, direct / tables);
+    printf("  max difference  %.2e rad  %.2e km\n", dLng, dRad);
+    return 0;
+}
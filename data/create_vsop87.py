@@ -0,0 +1,104 @@
+
+# Convert the complete VSOP87 series ( VSOP87B.* or VSOP87D.* files from
+# https://ftp.imcce.fr/pub/ephem/planets/vsop87/ ) into the binary layout
+# read by VSOP87Full ( include/hypatia/models/VSOP87Full.h ).
+#
+#   python create_vsop87.py <folder with VSOP87D.mer ... VSOP87D.nep> [vsop87d.bin]
+#
+import os
+import re
+import struct
+import sys
+
+VERSION = 1
+ENDIAN = 0x01020304
+PAGE = 4096
+
+# BodyId of each planet file
+planets = [ ('mer', 1), ('ven', 2), ('ear', 3), ('mar', 4), ('jup', 5), ('sat', 6), ('ura', 7), ('nep', 8) ]
+
+header_re = re.compile(r'VSOP87\s+VERSION\s+([A-E])\d\s+\w+\s+VARIABLE\s+(\d)\s+\(\w+\)\s+\*T\*\*(\d)\s+(\d+)\s+TERMS')
+
+def load_planet(filename):
+    # series[variable][power] = [ (A, B, C), ... ]
+    series = [ [ [] for p in range(6) ] for v in range(3) ]
+    theory = None
+    current = None
+    with open(filename, 'r') as f:
+        for line in f:
+            match = header_re.search(line)
+            if match:
+                theory = match.group(1)
+                current = series[int(match.group(2)) - 1][int(match.group(3))]
+                continue
+
+            fields = line.split()
+            if current is None or len(fields) < 3:
+                continue
+
+            # the last three columns of a term are A, B and C
+            current.append( (float(fields[-3]), float(fields[-2]), float(fields[-1])) )
+
+    # sorted by decreasing amplitude, like the Meeus tables
+    for v in range(3):
+        for p in range(6):
+            series[v][p].sort(key=lambda term: -abs(term[0]))
+
+    return theory, series
+
+folder = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(__file__)
+
+theory = None
+loaded = []
+for ext, body_id in planets:
+    names = [ n for n in os.listdir(folder) if n.upper().startswith('VSOP87') and n.lower().endswith('.' + ext) ]
+    if len(names) == 0:
+        print(f"No VSOP87 file for {ext} in {folder}")
+        continue
+
+    planet_theory, series = load_planet(os.path.join(folder, names[0]))
+    if planet_theory not in ('B', 'D'):
+        print(f"{names[0]} is VSOP87{planet_theory}, only the spherical versions B and D are supported")
+        sys.exit(1)
+
+    if theory is not None and theory != planet_theory:
+        print(f"{names[0]} is VSOP87{planet_theory} but previous files are VSOP87{theory}")
+        sys.exit(1)
+
+    theory = planet_theory
+    loaded.append( (body_id, series) )
+    print(f"Loaded {names[0]} with {sum(len(s) for v in series for s in v)} terms")
+
+if len(loaded) == 0:
+    sys.exit(1)
+
+output = sys.argv[2] if len(sys.argv) > 2 else 'vsop87' + theory.lower() + '.bin'
+
+header_size = struct.calcsize('<8sIIIc3x')
+record_size = struct.calcsize('<i18IIQQ')
+
+# every planet block starts on its own page
+offset = header_size + record_size * len(loaded)
+records = []
+for body_id, series in loaded:
+    offset = (offset + PAGE - 1) // PAGE * PAGE
+    rows = [ len(series[v][p]) for v in range(3) for p in range(6) ]
+    size = sum(rows) * 3 * 8
+    records.append( (body_id, rows, offset, size) )
+    offset += size
+
+with open(output, 'wb') as f:
+    f.write( struct.pack('<8sIIIc3x', b'HYPVSOP\0', VERSION, ENDIAN, len(loaded), theory.encode()) )
+    for body_id, rows, offset, size in records:
+        f.write( struct.pack('<i18IIQQ', body_id, *rows, 0, offset, size) )
+
+    for (body_id, series), (_, rows, offset, size) in zip(loaded, records):
+        f.write( b'\0' * (offset - f.tell()) )
+        for v in range(3):
+            for p in range(6):
+                terms = series[v][p]
+                f.write( struct.pack('<%dd' % len(terms), *[ t[0] for t in terms ]) )
+                f.write( struct.pack('<%dd' % len(terms), *[ t[1] for t in terms ]) )
+                f.write( struct.pack('<%dd' % len(terms), *[ t[2] for t in terms ]) )
+
+print(f"Wrote {output}")
@@ -10,6 +10,8 @@
 %include <typemaps.i>
 %include <std_vector.i>
 %include <std_string.i>
+%include <stdint.i>
+%include <exception.i>
 
 #pragma SWIG nowarn=509
 
@@ -22,6 +24,21 @@
 %ignore *::operator>;
 %ignore *::operator>=;
 %ignore operator<<;
+%ignore *::getCore;
+
+// C++ exceptions (invalid TLEs, ephemeris files, ...) are raised as RuntimeError
+%exception {
+    try {
+        $action
+    }
+    catch (const std::exception& e) {
+        SWIG_exception(SWIG_RuntimeError, e.what());
+    }
+}
+
+// VSOP87 itself is not wrapped, so neither are the calls taking its series or location types
+%ignore VSOP87Full::getSeries;
+%ignore VSOP87Full::calcLoc;
 
 %{
     #define SWIG_FILE_WITH_INIT
@@ -43,15 +60,23 @@
     #include "hypatia/coordinates/UTM.h"
     #include "hypatia/TimeOps.h"
     #include "hypatia/GeoOps.h"
+    #include "hypatia/EpochContext.h"
     #include "hypatia/Observer.h"
+    #include "hypatia/ObserverState.h"
     #include "hypatia/CoordOps.h"
     #include "hypatia/ProjOps.h"
     #include "hypatia/Body.h"
     #include "hypatia/Luna.h"
+    #include "hypatia/SolarSystemSnapshot.h"
+    #include "hypatia/ObserverGroup.h"
     #include "hypatia/Star.h"
+    #include "hypatia/StarIndex.h"
     #include "hypatia/Constellation.h"
     #include "hypatia/Satellite.h"
+    #include "hypatia/EventOps.h"
     #include "hypatia/models/TLE.h"
+    #include "hypatia/models/ChebyshevEphemeris.h"
+    #include "hypatia/models/VSOP87Full.h"
 %}
 
 %include "numpy.i"
@@ -62,6 +87,7 @@
 
 %apply double &OUTPUT { double &_x, double &_y };
 %apply double &OUTPUT { double &_lng, double &_lat };
+%apply double &OUTPUT { double &lon, double &lat, double &rad };
 
 %apply double &OUTPUT { int &_deg, int &_min, double &_sec };
 %apply double &OUTPUT { int &_hrs, int &_min, double &_sec };
@@ -73,8 +99,13 @@
 namespace std {
     %template(DoubleArray12) array<double, 12>;
     %template(IntVector) vector<int>;
+    %template(DoubleVector) vector<double>;
+    %template(SizeVector) vector<size_t>;
     %template(EquatorialVector) vector<Equatorial>;
+    %template(GeodeticVector) vector<Geodetic>;
+    %template(StarList) vector<Star>;
     %template(TileList) vector<Tile>;
+    %template(EventList) vector<Event>;
 };
 
 %include "include/hypatia/MathOps.h"
@@ -95,12 +126,26 @@ namespace std {
 %include "include/hypatia/coordinates/UTM.h"
 %include "include/hypatia/TimeOps.h"
 %include "include/hypatia/GeoOps.h"
+%include "include/hypatia/EpochContext.h"
 %include "include/hypatia/Observer.h"
+%include "include/hypatia/ObserverState.h"
 %include "include/hypatia/CoordOps.h"
 %include "include/hypatia/ProjOps.h"
 %include "include/hypatia/Body.h"
+
+// Body::Sample is nested, so its vector is made once Body is known
+namespace std {
+    %template(SampleVector) vector<Body::Sample>;
+};
+
 %include "include/hypatia/Luna.h"
+%include "include/hypatia/SolarSystemSnapshot.h"
+%include "include/hypatia/ObserverGroup.h"
 %include "include/hypatia/Star.h"
+%include "include/hypatia/StarIndex.h"
 %include "include/hypatia/Constellation.h"
 %include "include/hypatia/Satellite.h"
+%include "include/hypatia/EventOps.h"
 %include "include/hypatia/models/TLE.h"
+%include "include/hypatia/models/ChebyshevEphemeris.h"
+%include "include/hypatia/models/VSOP87Full.h"
@@ -15,6 +15,9 @@
 #include "coordinates/Horizontal.h"
 
 #include "Observer.h"
+#include "ObserverState.h"
+
+#include <vector>
 
 enum BodyId {
     NAB=-1, // NotABody
@@ -24,6 +27,8 @@ enum BodyId {
     SATELLITE=11
 };
 
+class SolarSystemSnapshot;
+
 class Body {
 public:
     Body();
@@ -43,6 +48,9 @@ public:
 
     // Geocentric
     virtual Ecliptic    getEclipticGeocentric() const { return m_geocentric; }
+
+    // Rectangular geocentric ecliptic velocity, per day. Evaluated on the first call after compute()
+    virtual Vector3     getEclipticVelocity(DISTANCE_UNIT _type = AU) const;
     
     virtual Equatorial  getEquatorial() const { return m_equatorial; }
     virtual Vector3     getEquatorialVector(DISTANCE_UNIT _type) const { return m_equatorial.getVector() * m_geocentric.getRadius(_type); }
@@ -54,12 +62,74 @@ public:
     //  Calculate the data for a given planet given an observer
     //  - This function must be called (directly or via c'tor) before calling any of the other fns!
     //  - If the observer have no location Horizontal coordinates will not be calculate and remain 0.0, 0.0
+    //  - Only what depends on what changed in the observer is recomputed: moving the observer at a fixed
+    //    time only updates the hour angle and horizontal coordinates
     //
     virtual void        compute( Observer& _obs );
+
+    //  Same as above but reading positions from a SolarSystemSnapshot computed at the observer's JD
+    //  - falls back to compute( _obs ) if the snapshot is for another JD
+    //
+    virtual void        compute( Observer& _obs, const SolarSystemSnapshot& _snapshot );
+
+    //  Same as above but taking Earth's position and the obliquity from an EpochContext
+    //  - falls back to compute( _obs ) if the context is for another JD
+    //
+    virtual void        compute( Observer& _obs, const EpochContext& _epoch );
+
+    //  Same as above from an immutable ObserverState. The state is only read, so one state can be
+    //  shared by threads computing different bodies
+    //
+    virtual void        compute( const ObserverState& _state );
+
+    // One sample of computeRange(), angles in radians and distances in AU
+    struct Sample {
+        double  jd;
+        double  hLng, hLat, hRad;   // heliocentric ecliptic
+        double  gLng, gLat, gRad;   // geocentric ecliptic
+        double  ra, dec;            // geocentric equatorial (mean of date)
+        double  ha, alt, az;        // hour angle and horizontal, 0.0 if the observer has no location
+    };
+
+    //  Number of samples in [ _jdStart, _jdEnd ] every _step days
+    //
+    static size_t       getRangeSize( double _jdStart, double _jdEnd, double _step );
+
+    //  Same as calling compute() at _jdStart, _jdStart + _step, ... up to _jdEnd for the observer's
+    //  location, writing getRangeSize() samples into _out. Returns the number of samples written,
+    //  0 for a body without a model (NAB)
+    //
+    virtual size_t      computeRange( const Observer& _obs, double _jdStart, double _jdEnd, double _step, Sample* _out ) const;
+
+    //  Same as above at _count explicit julian days. Returns _count, or 0 for a body without a model
+    //
+    virtual size_t      computeRange( const Observer& _obs, const double* _jds, size_t _count, Sample* _out ) const;
+
+    //  Same as above returning the samples
+    //
+    virtual std::vector<Sample> computeRange( const Observer& _obs, double _jdStart, double _jdEnd, double _step ) const;
+    virtual std::vector<Sample> computeRange( const Observer& _obs, const std::vector<double>& _jds ) const;
     
 protected:
+    // compute() runs in two stages: the time stage (heliocentric, geocentric, equatorial) when the
+    // observer's time changed, and the location stage (hour angle, horizontal) when either changed.
+    // These return true, and mark the stage current, when the observer changed since the last run
+    virtual bool        syncTime( const Observer& _obs );
+    virtual bool        syncLocation( const Observer& _obs );
+    virtual bool        syncTime( const ObserverState& _state );
+    virtual bool        syncLocation( const ObserverState& _state );
+
+    virtual void        computeHorizontal( Observer& _obs );
+    virtual void        computeHorizontal( const ObserverState& _state );
+    virtual void        computeVelocity() const;
+
+    // Fills the coordinates of computeRange() samples (with jd set) from 3 x _n heliocentric
+    // longitudes, latitudes and radius of the body (geocentric for LUNA and SATELLITE) and the Earth
+    static void         rangeSamples( BodyId _id, const Observer& _obs, const double* _loc, const double* _earth, size_t _n, Sample* _out );
+
     Ecliptic    m_heliocentric;
     Ecliptic    m_geocentric;
+    mutable Vector3 m_eclipticVelocity; // geocentric, AU per day, valid when m_bVelocity
     
     Equatorial  m_equatorial;
     Horizontal  m_horizontal;
@@ -67,9 +137,12 @@ protected:
     double      m_jcentury;
     double      m_ha;
     BodyId      m_bodyId;
+
+    unsigned long   m_timeVersion;      // Observer::getTimeVersion() of the last time stage
+    unsigned long   m_locationVersion;  // Observer::getLocationVersion() of the last location stage
     
     bool        m_bHorizontal;
-    bool        m_retrograde;
+    mutable bool m_bVelocity;
 };
 
 inline std::ostream& operator<<(std::ostream& strm, const Body& b) {
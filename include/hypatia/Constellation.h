@@ -9,28 +9,53 @@ public:
 
     static const int TOTAL;
 
+    // equinox of the boundaries (years)
+    static const double EPOCH;
+
     Constellation();
     Constellation( int _id );
     Constellation( char * _abbr );
     Constellation( const Equatorial &_point );
     Constellation( double _ra, double _dec );
 
+    // position at _epoch (years, 2000.0 for J2000), precessed to EPOCH
+    Constellation( const Equatorial &_point, double _epoch );
+
+    // constellation id ( -1 if none ) of positions in degrees at equinox 1875, read from a
+    // lookup raster. Batches are split among _threads worker threads (0 = one per hardware thread)
+    static int              classify( double _ra, double _dec );
+    static void             classify( const double* _ra, const double* _dec, size_t _count, int* _ids, unsigned _threads = 0 );
+    static std::vector<int> classify( const std::vector<double>& _ra, const std::vector<double>& _dec, unsigned _threads = 0 );
+
+    // same as classify( _ra, _dec ) by a linear search of the boundary table (slow, for reference)
+    static int              lookup( double _ra, double _dec );
+
+    // same for positions at _epoch (years), precessed to EPOCH with a matrix cached per epoch
+    static int              classifyAtEpoch( const Equatorial& _point, double _epoch );
+    static void             classifyAtEpoch( const double* _ra, const double* _dec, size_t _count, double _epoch, int* _ids, unsigned _threads = 0 );
+    static std::vector<int> classifyAtEpoch( const std::vector<double>& _ra, const std::vector<double>& _dec, double _epoch, unsigned _threads = 0 );
+
     void        setId( int _id );
     int         getId() const { return m_id; }
 
     std::string getName() const;
     std::string getAbbreviation() const;
 
-    Equatorial  getEquatorialCentroid() const { return m_centroid; }
+    Equatorial  getEquatorialCentroid() const;
+
+    // views over static tables, nothing is copied: star indices by pairs of line ends, and
+    // boundary vertices as right ascension, declination pairs in radians at equinox 1875
+    const int*      getStarIndicesData() const;
+    int             getTotalStarIndices() const;
+    const double*   getBoundaryData() const;
+    int             getTotalBoundaryPoints() const;
 
-    const std::vector<int>&        getStarIndices() const { return m_sIndices; }
-    const std::vector<Equatorial>& getBoundary() const { return m_boundary; }
+    // copies of the above
+    std::vector<int>        getStarIndices() const;
+    std::vector<Equatorial> getBoundary() const;
 
 protected:
     int                     m_id;
-    Equatorial              m_centroid;
-    std::vector<int>        m_sIndices;
-    std::vector<Equatorial> m_boundary;
 };
 
 inline std::ostream& operator<<(std::ostream& strm, const Constellation& c) {
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "Observer.h"
+#include "ObserverState.h"
 
 #include "coordinates/Galactic.h"
 #include "coordinates/Ecliptic.h"
@@ -50,6 +51,26 @@ public:
      * @return Ecliptic heliocentric
      */
     static Ecliptic toHeliocentric(Observer& _obs, const Ecliptic& _geocentric);
+
+    /**
+     * toHeliocentric() - ecliptic transformation from geocentric to heliocentric
+     *
+     * @param EpochContext
+     * @param Ecliptic geocentric
+     *
+     * @return Ecliptic heliocentric
+     */
+    static Ecliptic toHeliocentric(const EpochContext& _epoch, const Ecliptic& _geocentric);
+
+    /**
+     * toHeliocentric() - ecliptic transformation from geocentric to heliocentric
+     *
+     * @param ObserverState
+     * @param Ecliptic geocentric
+     *
+     * @return Ecliptic heliocentric
+     */
+    static Ecliptic toHeliocentric(const ObserverState& _state, const Ecliptic& _geocentric);
     
     // -------------------------------------------------- to GeoCentric (Ecliptic)
     
@@ -63,6 +84,26 @@ public:
      */
     static Ecliptic toGeocentric(Observer& _obs, const Ecliptic& _heliocentric );
 
+    /**
+     * toGeocentric() - ecliptic transformation from heliocentric to geocentric
+     *
+     * @param EpochContext
+     * @param Ecliptic heliocentric
+     *
+     * @return Ecliptic geocentric
+     */
+    static Ecliptic toGeocentric(const EpochContext& _epoch, const Ecliptic& _heliocentric );
+
+    /**
+     * toGeocentric() - ecliptic transformation from heliocentric to geocentric
+     *
+     * @param ObserverState
+     * @param Ecliptic heliocentric
+     *
+     * @return Ecliptic geocentric
+     */
+    static Ecliptic toGeocentric(const ObserverState& _state, const Ecliptic& _heliocentric );
+
     /**
      * toGeocentric() - ) Obliquity, right Ascention and declination to Ecliptic Geocentric
      *                          (Meeus, Ch. 93)
@@ -85,6 +126,32 @@ public:
      * @return Equatorial position
      */
     static Ecliptic toGeocentric (Observer& _obs, const ECI& _eci);
+    static Ecliptic toGeocentric (const ObserverState& _state, const ECI& _eci);
+
+    // -------------------------------------------------- Ecliptic velocity
+
+    /**
+     * toEclipticVelocity() - rates of ecliptic longitude, latitude and radius
+     *                        to a rectangular ecliptic velocity
+     *
+     * @param Ecliptic position
+     * @param longitude rate (radians per day)
+     * @param latitude rate (radians per day)
+     * @param radius rate (AU per day)
+     *
+     * @return velocity (AU per day)
+     */
+    static Vector3 toEclipticVelocity (const Ecliptic& _position, double _dLng, double _dLat, double _dRad);
+
+    /**
+     * toLongitudeRate() - rate of ecliptic longitude of a rectangular position and velocity
+     *
+     * @param position (AU)
+     * @param velocity (AU per day)
+     *
+     * @return longitude rate (radians per day), negative when retrograde
+     */
+    static double toLongitudeRate (const Vector3& _position, const Vector3& _velocity);
     
     // -------------------------------------------------- to Equatorial
 
@@ -120,6 +187,28 @@ public:
      * @return Equatorial position
      */
     static Equatorial toEquatorial (const Observer& _obs, const Ecliptic& _ecliptic );
+
+    /**
+     * toEquatorial() - ecliptic to equatorial coordinates
+     *                          (Meeus, Ch. 93)
+     *
+     * @param EpochContext
+     * @param Ecliptic position
+     *
+     * @return Equatorial position
+     */
+    static Equatorial toEquatorial (const EpochContext& _epoch, const Ecliptic& _ecliptic );
+
+    /**
+     * toEquatorial() - ecliptic to equatorial coordinates
+     *                          (Meeus, Ch. 93)
+     *
+     * @param ObserverState
+     * @param Ecliptic position
+     *
+     * @return Equatorial position
+     */
+    static Equatorial toEquatorial (const ObserverState& _state, const Ecliptic& _ecliptic );
     
     // -------------------------------------------------- to Earth Center Innertial (equatorial)
     
@@ -165,6 +254,7 @@ public:
      * @return hour angle
      */
     static double toHourAngle( const Observer& _obs, double _ra );
+    static double toHourAngle( const ObserverState& _state, double _ra );
     
     /**
      * toHourAngle() - calcuate hour angle (Meeus, Ch. 92)
@@ -175,6 +265,7 @@ public:
      * @return hour angle
      */
     static double toHourAngle( const Observer& _obs, const Equatorial& _equatorial );
+    static double toHourAngle( const ObserverState& _state, const Equatorial& _equatorial );
     
     // -------------------------------------------------- to TopoCentric
     /**
@@ -199,6 +290,7 @@ public:
      * @return horizontal position
      */
     static Horizontal toHorizontal( const Observer& _obs, const Equatorial& _equatorial);
+    static Horizontal toHorizontal( const ObserverState& _state, const Equatorial& _equatorial);
     
     /**
      * toECI() - Earth Center Innertial to Horizontal coordinates
@@ -209,6 +301,17 @@ public:
      * @return Horizontal coordinates
      */
     static Horizontal toHorizontal(const Observer& _obs, const ECI& _Eci);
+    static Horizontal toHorizontal(const ObserverState& _state, const ECI& _Eci);
+
+    /**
+     * toHorizontal() - Earth Center Innertial to Horizontal coordinates
+     *
+     * @param geodetic location of the observer
+     * @param Earth Center Innertial
+     *
+     * @return Horizontal coordinates
+     */
+    static Horizontal toHorizontal(const Geodetic& _location, const ECI& _Eci);
     
     // -------------------------------------------------- Other coordinates functions
     
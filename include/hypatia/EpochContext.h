@@ -0,0 +1,60 @@
+/*****************************************************************************\
+ * EpochContext.h
+ *
+ * Everything that depends only on the julian day, computed once and shared
+ * (read only) by every Observer, Body, Star and Satellite at that epoch.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "coordinates/Ecliptic.h"
+#include "primitives/Matrix3x3.h"
+
+class EpochContext {
+public:
+    EpochContext();
+    EpochContext( double _jd );
+    virtual ~EpochContext();
+
+    virtual double      getJD() const { return m_jd; }
+    virtual double      getJC() const { return m_jcentury; }
+
+    // mean obliquity of the ecliptic (radians)
+    virtual double      getObliquity() const { return m_obliquity; }
+
+    // nutation in longitude and obliquity
+    virtual double      getNutationLongitude( ANGLE_UNIT _type ) const;
+    virtual double      getNutationObliquity( ANGLE_UNIT _type ) const;
+
+    // Greenwich mean sidereal time, and the local one for a longitude in radians
+    //  (same as TimeOps::toLocalSideralTime())
+    virtual double      getGMST( ANGLE_UNIT _type = RADS ) const;
+    virtual double      getLST( double _lng ) const { return m_gmst + _lng; }
+
+    // Earth's heliocentric ecliptic position and velocity (per day)
+    virtual Ecliptic    getEarthHeliocentric() const { return m_earth; }
+    virtual Vector3     getEarthHeliocentricVector( DISTANCE_UNIT _type ) const;
+    virtual Vector3     getEarthHeliocentricVelocity( DISTANCE_UNIT _type ) const;
+
+    // rotation from rectangular ecliptic to equatorial coordinates (mean equinox of date)
+    virtual Matrix3x3   getEclipticToEquatorial() const { return m_eclipticToEquatorial; }
+
+    // powers of t (julian millenia) used by the VSOP87 series, see VSOP87::toPowers()
+    virtual const double* getPowers() const { return m_tPowers; }
+
+protected:
+    Matrix3x3   m_eclipticToEquatorial;
+    Ecliptic    m_earth;
+    Vector3     m_earthVector;      // AU
+    Vector3     m_earthVelocity;    // AU per day
+
+    double      m_tPowers[6];
+
+    double      m_jd;
+    double      m_jcentury;
+    double      m_obliquity;
+    double      m_nutationLng;      // arcseconds
+    double      m_nutationObl;      // arcseconds
+    double      m_gmst;             // radians
+};
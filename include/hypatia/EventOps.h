@@ -0,0 +1,71 @@
+/*****************************************************************************\
+ * EventOps.h
+ *
+ * Rise, transit and set times of bodies (Sun, planets, Luna, satellites) and
+ * stars seen by an observer over a range of julian days.
+ *
+ * Altitude and hour angle are sampled on a coarse grid, crossings are
+ * bracketed and then refined by regula falsi. Every call works on its own
+ * copies of the object and the observer, so it can run for many observers in
+ * parallel.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "Body.h"
+#include "Star.h"
+#include "Observer.h"
+
+#include <vector>
+
+enum EVENT_TYPE {
+    RISE = 0,       // altitude crosses the horizon going up
+    TRANSIT = 1,    // upper meridian transit (hour angle crosses 0)
+    SET = 2         // altitude crosses the horizon going down
+};
+
+struct Event {
+    double      jd;
+    EVENT_TYPE  type;
+    double      alt;        // radians
+    double      az;         // radians
+};
+
+class EventOps {
+public:
+    // horizon altitudes (degrees) for the usual events
+    static const double HORIZON_STAR;           // -0°34' of refraction
+    static const double HORIZON_SUN;            // refraction and the Sun's semidiameter
+    static const double HORIZON_LUNA;           // refraction, semidiameter and mean parallax
+    static const double CIVIL_TWILIGHT;         // Sun 6° below the horizon
+    static const double NAUTICAL_TWILIGHT;      // Sun 12° below the horizon
+    static const double ASTRONOMICAL_TWILIGHT;  // Sun 18° below the horizon
+
+    // standard horizon of a body (degrees): HORIZON_SUN, HORIZON_LUNA or HORIZON_STAR
+    static double getHorizon( BodyId _id );
+
+    // grid step (days) used when none is given: 1 hour, 30 minutes for Luna, 1 minute for satellites
+    static double getDefaultStep( BodyId _id );
+
+    // all the rise, transit and set events in [ _jd0, _jd1 ] sorted by time
+    //  - _step is the bracketing grid in days, 0.0 picks getDefaultStep()
+    //  - the observer's JD is not used, only its location
+    //  - Luna and Satellite are handled by their own compute()
+    //
+    static std::vector<Event> findEvents(   const Body& _body, const Observer& _obs,
+                                            double _jd0, double _jd1,
+                                            double _horizon_deg, double _step = 0.0 );
+    static std::vector<Event> findEvents(   const Star& _star, const Observer& _obs,
+                                            double _jd0, double _jd1,
+                                            double _horizon_deg = HORIZON_STAR, double _step = 0.0 );
+
+    // same as above for each observer, split among _threads worker threads (0 = one per hardware thread)
+    //
+    static std::vector< std::vector<Event> > findEvents(   const Body& _body, const std::vector<Observer>& _observers,
+                                                            double _jd0, double _jd1,
+                                                            double _horizon_deg, double _step = 0.0, unsigned _threads = 0 );
+    static std::vector< std::vector<Event> > findEvents(   const Star& _star, const std::vector<Observer>& _observers,
+                                                            double _jd0, double _jd1,
+                                                            double _horizon_deg = HORIZON_STAR, double _step = 0.0, unsigned _threads = 0 );
+};
@@ -5,6 +5,7 @@
 #include "hypatia/coordinates/Tile.h"
 #include "hypatia/primitives/Vector2.h"
 #include <iostream>
+#include <vector>
 
 class GeoOps {
     public:
@@ -96,10 +97,20 @@ class GeoOps {
     static double distance(double _lng1, double _lat1, double _lng2, double _lat2);
     static double distance(const Geodetic& _g1, const Geodetic& _g2);
 
-    // Find closest city Index
+    // Find closest city Index ( 0 if none within 50 km ), searched on a grid of cities built on first use
     static size_t findClosestCity(double _lng, double _lat);
     static size_t findClosestCity(const Geodetic& _g);
+    static std::vector<size_t> findClosestCity(const std::vector<Geodetic>& _g);
+
+    // Indices of the _k closest cities, and of the cities within _radius_km, closest first
+    static std::vector<size_t> findClosestCities(double _lng, double _lat, size_t _k);
+    static std::vector<size_t> findCitiesWithin(double _lng, double _lat, double _radius_km);
+
+    // Find cities by name, on a sorted index of the lowercase names built on first use
     static size_t findCity(const std::string& _place);
+    static size_t findCity(const std::string& _name, const std::string& _country);
+    static std::vector<size_t> findCities(const std::string& _name);
+    static std::vector<size_t> autocompleteCity(const std::string& _prefix, size_t _max = 10);
 
     // return City data
     static std::string getCityName(size_t _index);
@@ -26,6 +26,15 @@ struct LunarFundamentals {
 //
 class Luna : public Body {
 public:
+    // how the sin()/cos() of the ELP2000-82 terms are evaluated
+    //   - DIRECT: one libm call per term (reference)
+    //   - MULTIPLE_ANGLE: sin/cos of the multiples of D, M, M' and F are built once by
+    //     recurrence and each term is a few complex products (agrees within 1e-12 radians)
+    //   DIRECT is the default because it reproduces earlier results bit for bit; MULTIPLE_ANGLE
+    //   is about twice as fast and is opt-in
+    //
+    enum Evaluation { DIRECT = 0, MULTIPLE_ANGLE = 1 };
+
     Luna();
 
     static const double SYNODIC_MONTH;
@@ -49,11 +58,54 @@ public:
     // Position Angle of bright limb
     virtual double getPositionAngle(ANGLE_UNIT _type) const;
 
+    // evaluation used by compute()
+    virtual void setEvaluation( Evaluation _evaluation ) { m_evaluation = _evaluation; m_timeVersion = 0; }
+    virtual Evaluation getEvaluation() const { return m_evaluation; }
+
     // calculate all three location elements of the spec'd body at the given time
     virtual void compute( Observer &_obs );
 
+    // age and position angle are not part of the snapshot, so this runs the full model
+    //  with the snapshot's EpochContext
+    virtual void compute( Observer &_obs, const SolarSystemSnapshot& _snapshot );
+
+    // same as compute( _obs ) taking Earth's position from the context
+    virtual void compute( Observer &_obs, const EpochContext& _epoch );
+
+    // same as compute( _obs ) from an immutable ObserverState
+    virtual void compute( const ObserverState& _state );
+
+    // Ecliptic geocentric position (distance in km) at the given time. Touches no shared
+    // state, so it can be called from several threads at once
+    static Ecliptic computeGeocentric( double _jcentury, Evaluation _evaluation = DIRECT );
+
+    // same, also returning the geocentric velocity (AU per day)
+    static Ecliptic computeGeocentric( double _jcentury, Vector3& _velocity, Evaluation _evaluation = DIRECT );
+
+    // geocentric velocity (AU per day) at the given time and position, from the derivatives of the series
+    static Vector3 computeGeocentricVelocity( double _jcentury, const Ecliptic& _geocentric );
+
 private:
+    // ELP2000-82 truncated series: ecliptic geocentric lng/lat (radians) and distance (km)
+    static void calcGeocentric( double _jcentury, LunarFundamentals& _f, double& _lng, double& _lat, double& _rad, Evaluation _evaluation );
+
+    // derivatives of the series of calcGeocentric(): lng/lat (radians) and distance (km) per julian century
+    static void calcGeocentricRates( double _jcentury, const LunarFundamentals& _f, double& _dLng, double& _dLat, double& _dRad );
+
+    // fundamentals used by calcGeocentric() at the given time
+    static void calcFundamentals( double _jcentury, LunarFundamentals& _f );
+
+    // time stage of compute() given the obliquity and Earth's heliocentric position at the observer's JD
+    virtual void computeFromEarth( double _jcentury, double _obliquity, const Ecliptic& _earth );
+
+    // location stage of compute(), adds the position angle of the bright limb
+    virtual void computeHorizontal( Observer &_obs );
+    virtual void computeHorizontal( const ObserverState& _state );
+    virtual void computePositionAngle( const Horizontal& _sunHorizontal );
+
     LunarFundamentals m_f;      // our calculated fundmentals
+    Evaluation m_evaluation;
+    Equatorial m_sunEquatorial; // at the time of the last time stage
     
     double m_age, m_posAngle, m_distance;
 };
@@ -10,6 +10,7 @@
 
 #include "TimeOps.h"
 #include "GeoOps.h"
+#include "EpochContext.h"
 #include "coordinates/Geodetic.h"
 
 #include <array>
@@ -30,6 +31,10 @@ public:
     virtual void        setJD(double _jd);
     virtual void        setJDLocal(double _jd);
 
+    // same as setJD( _epoch.getJD() ) taking the obliquity, sidereal time and Earth's
+    // position from the shared context instead of computing them again
+    virtual void        setEpoch(const EpochContext& _epoch);
+
     virtual void        setTimezone(const char* _tz);
     virtual void        setTimezoneIndex(size_t _tz);
 
@@ -56,16 +61,28 @@ public:
     virtual std::string getTimezone() const;
     
     virtual Vector3     getHeliocentricVector(DISTANCE_UNIT _type);
+    virtual Vector3     getHeliocentricVelocity(DISTANCE_UNIT _type); // per day
 
     virtual double      getAscendant( ANGLE_UNIT _type );
     virtual double      getMidheaven( ANGLE_UNIT _type );
     virtual double      getNorthNode( ANGLE_UNIT _type );
     virtual std::array<double, 12>  getHousesPlacidus( ANGLE_UNIT _type );
 
+    // change counters for the cached results of Body::compute(): a new value, unique among
+    // all observers, every time the time (JD) or the location changes. Never 0
+    virtual unsigned long getTimeVersion() const { return m_timeVersion; }
+    virtual unsigned long getLocationVersion() const { return m_locationVersion; }
+
     virtual void        update();
 
 private:
-    Vector3             m_heliocentricLoc;
+    friend class ObserverState;     // default constructed states take versions of their own
+    static unsigned long nextVersion();
+    void                updateTime();
+    void                updateLocation();
+
+    Vector3             m_heliocentricLoc;  // AU
+    Vector3             m_heliocentricVel;  // AU per day
     Geodetic            m_location;
     size_t              m_cityId    = 0;
 
@@ -82,7 +99,11 @@ private:
     double              m_tzOffsetDST   = 0.0;
     size_t              m_tzIndex       = 0;
     
+    unsigned long       m_timeVersion       = 0;
+    unsigned long       m_locationVersion   = 0;
+
     bool                m_changed   = true;
+    bool                m_changedVel = true;
     bool                m_bLocation = false;
 };
 
@@ -0,0 +1,80 @@
+/*****************************************************************************\
+ * ObserverGroup.h
+ *
+ * Many observer locations sharing one epoch. Only the hour angle and the
+ * horizontal conversion depend on the location, so equatorial positions are
+ * solved once (Body, Star, SolarSystemSnapshot ...) and fanned out here to
+ * altitude/azimuth for every observer, as structure-of-arrays.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "EpochContext.h"
+#include "SolarSystemSnapshot.h"
+#include "coordinates/Equatorial.h"
+#include "coordinates/Geodetic.h"
+
+#include <vector>
+
+class ObserverGroup {
+public:
+    ObserverGroup();
+    ObserverGroup( const EpochContext& _epoch );
+    virtual ~ObserverGroup();
+
+    // lon & lat are passed in DEGREES
+    virtual void        add( double _lng_deg, double _lat_deg );
+    virtual void        add( const Geodetic& _location );
+    virtual void        addCity( size_t _cityId );
+    virtual void        reserve( size_t _total );
+    virtual void        clear();
+
+    virtual size_t      size() const { return m_lng.size(); }
+    virtual double      getLongitude( size_t _index, ANGLE_UNIT _type = DEGS ) const;
+    virtual double      getLatitude( size_t _index, ANGLE_UNIT _type = DEGS ) const;
+    virtual double      getLST( size_t _index, ANGLE_UNIT _type = RADS ) const;
+
+    // local sidereal time of every observer at the epoch of the context
+    virtual void        setEpoch( const EpochContext& _epoch );
+    virtual double      getJD() const { return m_jd; }
+
+    // worker threads used by toHorizontal(), 0 = one per hardware thread
+    virtual void        setThreads( unsigned _threads ) { m_threads = _threads; }
+    virtual unsigned    getThreads() const { return m_threads; }
+
+    // altitude, azimuth and (optionally) hour angle in radians of each position for
+    // every observer. Output is row major: _alt[ position * size() + observer ]
+    //
+    virtual void        toHorizontal(   const Equatorial* _equatorials, size_t _count,
+                                        double* _alt, double* _az, double* _ha = NULL ) const;
+
+    virtual void        toHorizontal(   const Equatorial& _equatorial,
+                                        std::vector<double>& _alt, std::vector<double>& _az ) const;
+    virtual void        toHorizontal(   const std::vector<Equatorial>& _equatorials,
+                                        std::vector<double>& _alt, std::vector<double>& _az ) const;
+
+    // one row per body of the snapshot ( SUN ... LUNA, the EARTH row is meaningless )
+    virtual void        toHorizontal(   const SolarSystemSnapshot& _snapshot,
+                                        std::vector<double>& _alt, std::vector<double>& _az ) const;
+
+protected:
+    virtual void        toHorizontalRange(  const Equatorial* _equatorials, size_t _count,
+                                            size_t _begin, size_t _end,
+                                            double* _alt, double* _az, double* _ha ) const;
+
+    // per observer, angles in radians
+    std::vector<double> m_lng;
+    std::vector<double> m_lat;
+    std::vector<double> m_sinLat;
+    std::vector<double> m_cosLat;
+
+    // per observer, at m_jd
+    std::vector<double> m_lst;
+    std::vector<double> m_sinLst;
+    std::vector<double> m_cosLst;
+
+    double              m_jd;
+    double              m_gmst;
+    unsigned            m_threads;
+};
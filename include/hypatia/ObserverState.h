@@ -0,0 +1,90 @@
+/*****************************************************************************\
+ * ObserverState.h
+ *
+ * Immutable snapshot of an Observer: every derived quantity (Earth's
+ * heliocentric position and velocity, sidereal time, ascendant, midheaven,
+ * lunar node) is evaluated in the constructor and all the accessors are
+ * const, so one state can be read by many threads at once.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "Observer.h"
+#include "EpochContext.h"
+
+#include <array>
+
+class ObserverState {
+public:
+    ObserverState();
+    explicit ObserverState( const Observer& _obs );
+
+    // same as above taking Earth's position from the context when it is at the observer's JD
+    ObserverState( const Observer& _obs, const EpochContext& _epoch );
+    virtual ~ObserverState();
+
+    virtual double      getJD() const { return m_jd; }
+    virtual double      getJC() const { return m_jcentury; }
+    virtual double      getObliquity() const { return m_obliquity; }
+
+    virtual bool        haveLocation() const { return m_bLocation; }
+    virtual Geodetic    getLocation() const;
+    virtual double      getLST( ANGLE_UNIT _type = RADS ) const;
+
+    // Earth's heliocentric ecliptic position and velocity (per day)
+    virtual Ecliptic    getEarthHeliocentric() const { return m_earth; }
+    virtual Vector3     getHeliocentricVector( DISTANCE_UNIT _type ) const;
+    virtual Vector3     getHeliocentricVelocity( DISTANCE_UNIT _type ) const;
+
+    virtual double      getAscendant( ANGLE_UNIT _type ) const;
+    virtual double      getMidheaven( ANGLE_UNIT _type ) const;
+    virtual double      getNorthNode( ANGLE_UNIT _type ) const;
+
+    // evaluated on each call (nothing is cached)
+    virtual std::array<double, 12>  getHousesPlacidus( ANGLE_UNIT _type ) const;
+
+    // versions of the Observer this state was taken from, see Observer::getTimeVersion()
+    virtual unsigned long getTimeVersion() const { return m_timeVersion; }
+    virtual unsigned long getLocationVersion() const { return m_locationVersion; }
+
+    // formulas shared with Observer
+    static double       toAscendant( double _lst, double _obliquity, double _lat );     // radians
+    static double       toMidheaven( double _lst, double _obliquity );                  // radians
+    static double       toNorthNode( double _jd );                                       // degrees
+    static std::array<double, 12> toHousesPlacidus( double _ascendant_deg, double _midheaven_deg,
+                                                    double _lst, double _obliquity, double _lat,
+                                                    ANGLE_UNIT _type );
+
+protected:
+    void                init( const Observer& _obs );
+
+    Geodetic        m_location;
+    Ecliptic        m_earth;
+    Vector3         m_earthVector;      // AU
+    Vector3         m_earthVelocity;    // AU per day
+
+    double          m_jd;
+    double          m_jcentury;
+    double          m_obliquity;
+    double          m_lst;
+    double          m_ascendant;        // radians
+    double          m_midheaven;        // radians
+    double          m_northNode;        // degrees
+
+    unsigned long   m_timeVersion;
+    unsigned long   m_locationVersion;
+
+    bool            m_bLocation;
+};
+
+inline std::ostream& operator<<(std::ostream& strm, const ObserverState& o) {
+    strm << "ObserverState, jd:" << std::setw(8) << o.getJD();
+    strm << ", " << std::setw(8) << TimeOps::formatDateTime(o.getJD(), Y_M_D_HM);
+    strm << ", obliq:" << std::setw(8) << MathOps::formatAngle(o.getObliquity(), RADS, Dd);
+    if ( o.haveLocation() ) {
+        strm << ", " << o.getLocation();
+        strm << ", lst:" << std::setw(8) << MathOps::formatAngle(o.getLST(), DEGS, Dd);
+    }
+    return strm;
+}
@@ -21,6 +21,14 @@ public:
     virtual char*       getName() const;
     
     virtual void        compute( Observer& _obs );
+    virtual void        compute( Observer& _obs, const EpochContext& _epoch );
+    virtual void        compute( const ObserverState& _state );
+
+    //  Same as Body::computeRange(), propagating the TLE with SGP4 at every sample
+    //
+    using Body::computeRange;
+    virtual size_t      computeRange( const Observer& _obs, double _jdStart, double _jdEnd, double _step, Sample* _out ) const;
+    virtual size_t      computeRange( const Observer& _obs, const double* _jds, size_t _count, Sample* _out ) const;
     
 protected:
     SGP4        m_sgp4;
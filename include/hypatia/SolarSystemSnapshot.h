@@ -0,0 +1,60 @@
+/*****************************************************************************\
+ * SolarSystemSnapshot.h
+ *
+ * Positions of the Sun, planets, Pluto and Luna at one epoch, computed in a
+ * single pass on top of an EpochContext, so Earth's series, the powers of t,
+ * the obliquity and the nutation are evaluated once instead of once per Body.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "Body.h"
+#include "EpochContext.h"
+
+class SolarSystemSnapshot {
+public:
+    static const int TOTAL;     // number of bodies in the table ( SUN ... LUNA )
+
+    SolarSystemSnapshot();
+    SolarSystemSnapshot( double _jd );
+    SolarSystemSnapshot( const EpochContext& _epoch );
+    virtual ~SolarSystemSnapshot();
+
+    // evaluate every body at the given julian day
+    virtual void        compute( double _jd );
+
+    // evaluate every body at the epoch of an already computed context
+    virtual void        compute( const EpochContext& _epoch );
+
+    virtual double      getJD() const { return m_epoch.getJD(); }
+    virtual double      getJC() const { return m_epoch.getJC(); }
+
+    // shared quantities
+    virtual const EpochContext& getEpoch() const { return m_epoch; }
+    virtual double      getObliquity() const { return m_epoch.getObliquity(); }
+    virtual double      getNutationLongitude( ANGLE_UNIT _type ) const { return m_epoch.getNutationLongitude(_type); }
+    virtual double      getNutationObliquity( ANGLE_UNIT _type ) const { return m_epoch.getNutationObliquity(_type); }
+    virtual Vector3     getEarthHeliocentricVector( DISTANCE_UNIT _type ) const { return m_epoch.getEarthHeliocentricVector(_type); }
+
+    // table lookups, an id outside SUN ... LUNA returns an empty coordinate
+    virtual bool        have( BodyId _id ) const { return m_epoch.getJD() != 0.0 && _id >= SUN && _id <= LUNA; }
+    virtual Ecliptic    getEclipticHeliocentric( BodyId _id ) const;
+    virtual Ecliptic    getEclipticGeocentric( BodyId _id ) const;
+    virtual Equatorial  getEquatorial( BodyId _id ) const;
+    virtual Vector3     getEclipticVelocity( BodyId _id ) const;  // geocentric, AU per day
+
+    // one row of the table, angles in radians and distances in AU
+    struct Entry {
+        double  hLng, hLat, hRad;   // heliocentric ecliptic
+        double  gLng, gLat, gRad;   // geocentric ecliptic
+        double  ra, dec;            // geocentric equatorial (mean of date)
+        double  vx, vy, vz;         // geocentric ecliptic velocity (AU per day)
+    };
+
+    virtual const Entry& getEntry( BodyId _id ) const;
+
+protected:
+    Entry           m_table[LUNA + 1];
+    EpochContext    m_epoch;
+};
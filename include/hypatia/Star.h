@@ -1,11 +1,13 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "coordinates/Equatorial.h"
 #include "coordinates/Horizontal.h"
 #include "coordinates/PrecessionMatrix.h"
 
 #include "Observer.h"
+#include "ObserverState.h"
 
 #define USE_HIPPACOS_EXTRADATA
 
@@ -25,6 +27,13 @@ public:
 
     virtual int         getId() const { return m_id; };
 
+    // catalog index of a Hipparcos number ( -1 if not in the catalog ), by binary search
+    static int          getIdFromHIP( int _hip );
+
+    // same as Star( _hip, HIP ) for each number of a list
+    static std::vector<Star> fromHIP( const int* _hips, size_t _count );
+    static std::vector<Star> fromHIP( const std::vector<int>& _hips );
+
     virtual int         getHIP() const;
     virtual std::string getName() const;
 
@@ -50,6 +59,18 @@ public:
 
     virtual void        compute( Observer& _obs );
     virtual void        compute( Observer& _obs, const PrecessionMatrix& _matrix );
+    virtual void        compute( Observer& _obs, const EpochContext& _epoch );
+    virtual void        compute( const ObserverState& _state );
+
+    // Altitude, azimuth and (optionally) hour angle in radians of every star of the catalog,
+    // TOTAL values each, indexed like Star( _id ). Same as compute() on each star (up to rounding)
+    //  - with a PrecessionMatrix the J2000 positions are precessed first, like compute( _obs, _matrix )
+    //  - if the observer has no location everything is 0.0
+    //
+    static void         computeAll( Observer& _obs, double* _alt, double* _az, double* _ha = NULL );
+    static void         computeAll( Observer& _obs, const PrecessionMatrix& _matrix, double* _alt, double* _az, double* _ha = NULL );
+    static void         computeAll( Observer& _obs, std::vector<double>& _alt, std::vector<double>& _az );
+    static void         computeAll( Observer& _obs, const PrecessionMatrix& _matrix, std::vector<double>& _alt, std::vector<double>& _az );
     
 protected:
 
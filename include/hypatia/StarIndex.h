@@ -0,0 +1,39 @@
+/*****************************************************************************\
+ * StarIndex.h
+ *
+ * Spatial index over the star catalog for cone and field of view queries.
+ *
+ * The sky is cut in declination zones, each split in right ascension cells
+ * of about the same width on the sky. Every cell keeps its stars sorted by
+ * magnitude, so a query only visits the cells it overlaps and stops in each
+ * one at the magnitude limit. Built once, on first use.
+ *
+ * Positions are the J2000 ones of the catalog, Star( _id ).getEquatorial().
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "Star.h"
+
+#include <vector>
+
+class StarIndex {
+public:
+    // magnitude limit that keeps every star
+    static const double MAG_ALL;
+
+    // catalog ids ( for Star( _id ) ) of the stars within _radius of _center and not
+    // fainter than _magLimit, brightest first
+    static std::vector<int> starsInCone(    const Equatorial& _center, double _radius, ANGLE_UNIT _type,
+                                            double _magLimit = MAG_ALL );
+
+    // same for a convex spherical polygon smaller than a hemisphere (a field of view) given
+    // by its vertices in order, either direction. Less than 3 vertices gives no stars
+    static std::vector<int> starsInPolygon( const std::vector<Equatorial>& _vertices,
+                                            double _magLimit = MAG_ALL );
+
+    // cells of the index, for debugging and statistics
+    static int          getTotalCells();
+    static int          getCell( const Equatorial& _position );
+};
@@ -10,7 +10,10 @@ public:
     Ecliptic ();
     Ecliptic (const Vector3& _parent, DISTANCE_UNIT _type);
     Ecliptic (double _lng, double _lat, double _radius, ANGLE_UNIT _a_type, DISTANCE_UNIT _d_type);
+    Ecliptic (const hypatia::ecl_coord& _core) : Polar(_core.lng, _core.lat, RADS), m_radius(_core.radius) {}
     virtual ~Ecliptic();
+
+    hypatia::ecl_coord getCore() const { return hypatia::ecl_coord{ m_phi, m_theta, m_radius }; }
     
     virtual Ecliptic& operator= (const Vector3& _vec);
     
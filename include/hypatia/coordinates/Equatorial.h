@@ -10,8 +10,11 @@ public:
     Equatorial();
     Equatorial(const Vector3& _parent);
     Equatorial(const double _ra, const double _dec, ANGLE_UNIT _type);
+    Equatorial(const hypatia::eq_coord& _core) : Polar(_core.ra, _core.dec, RADS) {}
     virtual ~Equatorial();
 
+    hypatia::eq_coord getCore() const { return hypatia::eq_coord{ m_phi, m_theta }; }
+
     virtual double  getRightAscension(ANGLE_UNIT _type) const;
     virtual double  getDeclination(ANGLE_UNIT _type) const;
     
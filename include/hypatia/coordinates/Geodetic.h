@@ -6,8 +6,11 @@ class Geodetic : public Polar {
 public:
     Geodetic();
     Geodetic( double _lng, double _lat, double _alt, ANGLE_UNIT _a_type, DISTANCE_UNIT _alt_unit );
+    Geodetic( const hypatia::geo_coord& _core ) : Polar(_core.lng, _core.lat, RADS), m_alt(_core.alt) {}
     virtual ~Geodetic();
 
+    hypatia::geo_coord getCore() const { return hypatia::geo_coord{ m_phi, m_theta, m_alt }; }
+
     virtual void    setLongitude( double _lng, ANGLE_UNIT _type );
     virtual void    setLatitude( double _lat, ANGLE_UNIT _type );
     virtual void    setAltitude( double _alt, DISTANCE_UNIT _type );
@@ -10,7 +10,10 @@ public:
     Horizontal();
     Horizontal( const Vector3& _parent );
     Horizontal(const double _alt, const double _az, ANGLE_UNIT _type);
+    Horizontal(const hypatia::hor_coord& _core) : Polar(_core.alt, _core.az, RADS) {}
     virtual ~Horizontal();
+
+    hypatia::hor_coord getCore() const { return hypatia::hor_coord{ m_phi, m_theta }; }
     
     virtual double  getAltitud(ANGLE_UNIT _type) const;
     virtual double  getAzimuth(ANGLE_UNIT _type) const;
@@ -0,0 +1,125 @@
+/*****************************************************************************\
+ * ChebyshevEphemeris.h
+ *
+ * Chebyshev-compressed ephemeris of the planets, Pluto and Luna.
+ *
+ * Like JPL's DE files, the time range is split into fixed intervals per body
+ * and the rectangular ecliptic coordinates (of date, AU) in each interval are
+ * approximated by Chebyshev polynomials fitted to the full models (VSOP87,
+ * Pluto and Luna). Reading a position then costs a few dozen multiply-adds
+ * instead of summing thousands of periodic terms.
+ *
+ * Largest distance to the models, relative to the body's distance (measured
+ * from 1800 to 2200):
+ *   Mercury 3e-11, Venus 1e-11, Earth and Mars 6e-12, Luna 6e-11,
+ *   Jupiter and Saturn 6e-13, Uranus and Neptune 1e-13,
+ *   Pluto 2e-8: its model solves Kepler's equation to 1e-8 radians only, so
+ *   it jumps by that much when the number of iterations changes.
+ *
+ * The coefficients live in a versioned binary file that is memory-mapped on
+ * load (read into memory on platforms without mmap).
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "../Body.h"  // for enum Body
+#include "MappedFile.h"
+
+#include <stdint.h>
+#include <string>
+
+// File header, all fields in native byte order
+struct ChebyshevHeader {
+    char        magic[8];       // "HYPCHEB\0"
+    uint32_t    version;        // ChebyshevEphemeris::VERSION
+    uint32_t    endian;         // 0x01020304 as written by the generator
+    uint32_t    bodies;         // number of ChebyshevBody records that follow
+    uint32_t    reserved;
+    double      jdStart;        // first julian day covered
+    double      jdEnd;          // last julian day covered
+};
+
+// Per body record, coefficients are stored per interval as
+// x[degree+1], y[degree+1], z[degree+1]
+struct ChebyshevBody {
+    int32_t     id;             // BodyId
+    uint32_t    degree;         // polynomial degree
+    uint32_t    intervals;      // number of intervals
+    uint32_t    reserved;
+    double      jdStart;        // start of the first interval
+    double      span;           // interval length in days
+    uint64_t    offset;         // byte offset of the coefficients from the start of the file
+};
+
+class ChebyshevEphemeris {
+public:
+    static const uint32_t VERSION;
+
+    ChebyshevEphemeris();
+    ChebyshevEphemeris( const std::string& _filename );
+    virtual ~ChebyshevEphemeris();
+
+    ChebyshevEphemeris( const ChebyshevEphemeris& ) = delete;
+    ChebyshevEphemeris& operator= ( const ChebyshevEphemeris& ) = delete;
+
+    /**
+     * build() - fit every body over [_jdStart, _jdEnd] and write the coefficients to a file
+     *
+     * Planets (and Earth) are fitted heliocentric, Luna geocentric. Interval
+     * lengths and degrees follow the DE layout (4 days for Luna, 8 for Mercury,
+     * 16 for Venus, Earth and Mars, 32 for Jupiter and Saturn, 64 for the rest).
+     * Intervals are aligned on J2000, so the first may start before _jdStart.
+     *
+     * @param _filename - output file
+     * @param _jdStart - first julian day to cover
+     * @param _jdEnd - last julian day to cover
+     *
+     * @throws Exception if the range is empty or the file can't be written
+     */
+    static void build( const std::string& _filename, double _jdStart, double _jdEnd );
+
+    /**
+     * load() - map an ephemeris file previously written by build()
+     *
+     * @throws Exception if the file can't be opened or is not a valid ephemeris of this VERSION
+     */
+    virtual void        load( const std::string& _filename );
+    virtual void        close();
+
+    virtual bool        isLoaded() const { return m_file.isOpen(); }
+    virtual double      getJDStart() const { return m_jdStart; }
+    virtual double      getJDEnd() const { return m_jdEnd; }
+
+    // true for the bodies the file covers (SUN and EARTH are always available together)
+    virtual bool        have( BodyId _id ) const;
+
+    /**
+     * getHeliocentricVector() - rectangular ecliptic heliocentric position (AU)
+     *
+     * SUN is the origin, LUNA is Earth plus its geocentric position.
+     *
+     * @throws Exception if the body is not in the file or _jd is out of range
+     */
+    virtual Vector3     getHeliocentricVector( BodyId _id, double _jd ) const;
+
+    /**
+     * getGeocentricVector() - rectangular ecliptic geocentric position (AU)
+     *
+     * @throws Exception if the body is not in the file or _jd is out of range
+     */
+    virtual Vector3     getGeocentricVector( BodyId _id, double _jd ) const;
+
+    // Same conventions as Body::compute(): SUN's heliocentric position is Earth's
+    virtual Ecliptic    getEclipticHeliocentric( BodyId _id, double _jd ) const;
+    virtual Ecliptic    getEclipticGeocentric( BodyId _id, double _jd ) const;
+
+protected:
+    virtual Vector3     eval( BodyId _id, double _jd ) const;
+
+    MappedFile              m_file;
+    const ChebyshevBody*    m_bodies[LUNA + 1];
+
+    double                  m_jdStart;
+    double                  m_jdEnd;
+};
@@ -0,0 +1,43 @@
+/*****************************************************************************\
+ * MappedFile.h
+ *
+ * Read-only view of a binary data file. The file is memory-mapped where mmap
+ * is available, so pages are only read from disk when first touched, and
+ * read into an 8-byte aligned buffer otherwise (_WIN32).
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class MappedFile {
+public:
+    MappedFile();
+    virtual ~MappedFile();
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator= ( const MappedFile& ) = delete;
+
+    /**
+     * open() - map (or read) a whole file
+     *
+     * @throws Exception if the file can't be opened, mapped or read
+     */
+    virtual void        open( const std::string& _filename );
+    virtual void        close();
+
+    virtual bool        isOpen() const { return m_data != 0; }
+    virtual bool        isMapped() const { return m_mapped; }
+
+    virtual const char* getData() const { return m_data; }
+    virtual size_t      getSize() const { return m_size; }
+
+private:
+    const char*             m_data;
+    size_t                  m_size;
+    std::vector<double>     m_buffer;   // file contents when not memory-mapped
+    bool                    m_mapped;
+};
@@ -22,5 +22,6 @@ struct PlutoCoeffs {
 class Pluto {
 public:
     static void calcAllLocs (double& _lon, double& _lat, double& _r, const double _jcentury);
+    static void calcAllLocsAndRates (double& _lon, double& _lat, double& _r, double& _dLon, double& _dLat, double& _dR, const double _jcentury);
 };
 
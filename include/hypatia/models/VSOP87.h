@@ -31,6 +31,18 @@ struct VSOP87Terms {
     VSOP87Terms( unsigned r, const VSOP87Set* p ) : rows(r), pTerms(p) {}
 };
 
+// A set of VSOP terms stored as separate A, B and C arrays (structure of arrays),
+// the layout used by the vectorized evaluation engine
+struct VSOP87Series {
+    unsigned        rows;   // number of terms
+    const double*   A;      // amplitudes
+    const double*   B;      // phases
+    const double*   C;      // frequencies
+
+    VSOP87Series() : rows(0), A(0), B(0), C(0) {}
+    VSOP87Series( unsigned r, const double* a, const double* b, const double* c ) : rows(r), A(a), B(b), C(c) {}
+};
+
 // A complete collection of VSOP terms (6 Lat, 6 Lon, 6 Rad )
 
 typedef const VSOP87Terms AstroTerms[3*6];
@@ -43,6 +55,21 @@ public:
     //
     enum LocType { ECLIPTIC_LON = 0, ECLIPTIC_LAT = 1, RADIUS = 2 };
 
+    // instruction sets the structure-of-arrays engine can sum the series with
+    //
+    enum Kernel { SCALAR = 0, NEON = 1, AVX2 = 2, AVX512 = 3 };
+
+    // accuracy tiers the series can be truncated to (see getPrecisionTarget())
+    //
+    enum Precision { FULL = 0, ARCSEC = 1, ARCMIN = 2, DEGREE = 3 };
+
+    // return the spec'd series (power 0...5) of the spec'd body as stored in the tables
+    //
+    static const VSOP87Terms& getTerms(
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          int power);             // power of t the series is multiplied by (0...5)
+
     // calculate the spec'd location element of the spec'd body at the given time
     //
     static double calcLoc(
@@ -50,6 +77,14 @@ public:
                           BodyId planet,          // must be in the range SUN...NEPTUNE
                           LocType value);         // 0=ecliptic lon, 1=ecliptic lat, 2=radius
 
+    // same as calcLoc() for a body and location element fixed at compile time,
+    //  i.e. VSOP87::eval<MARS, VSOP87::RADIUS>(cen). Every loop runs over a constant
+    //  number of terms so the compiler can unroll it, and the result matches calcLoc()
+    //  bit-for-bit (calcLoc() dispatches to these). Instantiated for MERCURY...NEPTUNE
+    //
+    template<BodyId planet, LocType value>
+    static double eval( double cen );     // time in decimal centuries
+
     // calculate all three location elements of the spec'd body at the given time
     //
     static void calcAllLocs(
@@ -63,4 +98,203 @@ public:
         lat = calcLoc( cen, planet, ECLIPTIC_LAT );
         rad = calcLoc( cen, planet, RADIUS );
     }
+
+    // calculate the spec'd location element and its rate of change at the given time,
+    //  both in the same pass over the tables (value matches calcLoc() bit-for-bit)
+    //
+    static void calcLocAndRate(
+                          double cen,             // time in decimal centuries
+                          BodyId planet,          // must be in the range SUN...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          double& _value,         // returned location element
+                          double& _rate);         // returned rate (radians or AU per day)
+
+    // calculate all three location elements and their rates at the given time
+    //
+    static void calcAllLocsAndRates(
+                            double& lon,            // returned longitude
+                            double& lat,            // returned latitude
+                            double& rad,            // returned radius vector
+                            double& dLon,           // returned longitude rate (radians per day)
+                            double& dLat,           // returned latitude rate (radians per day)
+                            double& dRad,           // returned radius rate (AU per day)
+                            double cen,             // time in decimal centuries
+                            BodyId planet)          // must be in the range SUN...NEPTUNE
+    {
+        calcLocAndRate( cen, planet, ECLIPTIC_LON, lon, dLon );
+        calcLocAndRate( cen, planet, ECLIPTIC_LAT, lat, dLat );
+        calcLocAndRate( cen, planet, RADIUS, rad, dRad );
+    }
+
+    // * * * * * accuracy tiers * * * * *
+
+    // target truncation error of a tier in arcseconds (0 for FULL). Radius series are
+    //  truncated to the same relative error ( target x mean distance of the body )
+    //
+    static double getPrecisionTarget( Precision _precision );
+
+    // number of leading terms of the spec'd series kept by a tier. Tables are sorted
+    //  by decreasing |A|, so truncating is just a shorter loop
+    //
+    static unsigned getTermsCount(
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          int power,              // power of t the series is multiplied by (0...5)
+                          Precision _precision );
+
+    // worst-case error of a tier against the full tables for |cen| <= 10 centuries,
+    //  the sum of the dropped |A| (radians for lon/lat, AU for radius)
+    //
+    static double getErrorBound(
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          Precision _precision );
+
+    // same as calcLoc() summing only the terms kept by the spec'd tier
+    //
+    static double calcLoc(
+                          double cen,             // time in decimal centuries
+                          BodyId planet,          // must be in the range SUN...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          Precision _precision );
+
+    static void calcAllLocs(
+                            double& lon,            // returned longitude
+                            double& lat,            // returned latitude
+                            double& rad,            // returned radius vector
+                            double cen,             // time in decimal centuries
+                            BodyId planet,          // must be in the range SUN...NEPTUNE
+                            Precision _precision)
+    {
+        lon = calcLoc( cen, planet, ECLIPTIC_LON, _precision );
+        lat = calcLoc( cen, planet, ECLIPTIC_LAT, _precision );
+        rad = calcLoc( cen, planet, RADIUS, _precision );
+    }
+
+    // * * * * * structure-of-arrays engine * * * * *
+
+    // the fastest kernel this CPU can run (picked once at runtime)
+    //
+    static Kernel getKernel();
+
+    // true when the spec'd kernel was compiled in and is supported by this CPU
+    //
+    static bool isKernelSupported( Kernel _kernel );
+
+    // return the spec'd series in structure-of-arrays layout
+    //
+    static const VSOP87Series& getSeries(
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          int power);             // power of t the series is multiplied by (0...5)
+
+    // sum A x cos( B + C x t ) over every row of the series
+    //   - SCALAR uses libm cos() in table order, exactly like calcLoc()
+    //   - vector kernels use a polynomial cosine (<= 2 ulp per term) and sum in lanes
+    //   - an unsupported kernel falls back to SCALAR
+    //
+    static double sumSeries( const VSOP87Series& _series, double t, Kernel _kernel = getKernel() );
+
+    // same as calcLoc() but evaluated by the structure-of-arrays engine.
+    //   With the SCALAR kernel the result matches calcLoc() bit-for-bit, with a vector
+    //   kernel it agrees within 2e-12 (radians or AU) for |cen| <= 1 and 1e-10 for |cen| <= 40
+    //
+    static double calcLocSIMD(
+                          double cen,             // time in decimal centuries
+                          BodyId planet,          // must be in the range SUN...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          Kernel _kernel = getKernel() );
+
+    // fill the six powers of t (in julian millenia) the series are multiplied by
+    //
+    static void toPowers( double cen, double _tPowers[6] );
+
+    // same as calcLocSIMD() for powers of t already computed by toPowers(),
+    //  so several bodies at the same epoch share them
+    //
+    static double calcLocSIMD(
+                          const double _tPowers[6], // from toPowers()
+                          BodyId planet,          // must be in the range SUN...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          Kernel _kernel = getKernel() );
+
+    // calculate all three location elements using the structure-of-arrays engine
+    //
+    static void calcAllLocsSIMD(
+                            double& lon,            // returned longitude
+                            double& lat,            // returned latitude
+                            double& rad,            // returned radius vector
+                            double cen,             // time in decimal centuries
+                            BodyId planet)          // must be in the range SUN...NEPTUNE
+    {
+        lon = calcLocSIMD( cen, planet, ECLIPTIC_LON );
+        lat = calcLocSIMD( cen, planet, ECLIPTIC_LAT );
+        rad = calcLocSIMD( cen, planet, RADIUS );
+    }
+
+    static void calcAllLocsSIMD(
+                            double& lon,            // returned longitude
+                            double& lat,            // returned latitude
+                            double& rad,            // returned radius vector
+                            const double _tPowers[6], // from toPowers()
+                            BodyId planet)          // must be in the range SUN...NEPTUNE
+    {
+        lon = calcLocSIMD( _tPowers, planet, ECLIPTIC_LON );
+        lat = calcLocSIMD( _tPowers, planet, ECLIPTIC_LAT );
+        rad = calcLocSIMD( _tPowers, planet, RADIUS );
+    }
+
+    // return the series of the derivative of the spec'd series, stored as
+    //  -A x C x cos( B - PI/2 + C x t ) so the same kernels sum it
+    //
+    static const VSOP87Series& getRateSeries(
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          int power);             // power of t the series is multiplied by (0...5)
+
+    // same as calcLocAndRate() evaluated by the structure-of-arrays engine
+    //
+    static void calcLocAndRateSIMD(
+                          const double _tPowers[6], // from toPowers()
+                          BodyId planet,          // must be in the range SUN...NEPTUNE
+                          LocType value,          // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          double& _value,         // returned location element
+                          double& _rate,          // returned rate (radians or AU per day)
+                          Kernel _kernel = getKernel() );
+
+    static void calcAllLocsAndRatesSIMD(
+                            double& lon,            // returned longitude
+                            double& lat,            // returned latitude
+                            double& rad,            // returned radius vector
+                            double& dLon,           // returned longitude rate (radians per day)
+                            double& dLat,           // returned latitude rate (radians per day)
+                            double& dRad,           // returned radius rate (AU per day)
+                            const double _tPowers[6], // from toPowers()
+                            BodyId planet)          // must be in the range SUN...NEPTUNE
+    {
+        calcLocAndRateSIMD( _tPowers, planet, ECLIPTIC_LON, lon, dLon );
+        calcLocAndRateSIMD( _tPowers, planet, ECLIPTIC_LAT, lat, dLat );
+        calcLocAndRateSIMD( _tPowers, planet, RADIUS, rad, dRad );
+    }
+
+    // * * * * * uniform time-step sweep * * * * *
+
+    // calculate all three location elements at n evenly spaced times
+    //  cen0, cen0 + dcen, ... cen0 + (n-1) x dcen.
+    //   Instead of calling cos() for every term at every step, each term's
+    //   cos/sin pair is rotated by the constant angle C x dt (angle-addition
+    //   recurrence) and re-seeded with cos()/sin() every _reseed steps to
+    //   bound the accumulated rounding. For steps up to 0.02 centuries it agrees
+    //   with calcLoc() within 1e-12 (radians or AU) for |cen| <= 1 and 2e-11 for
+    //   |cen| <= 10. Near those limits the difference comes from the t^i factors
+    //   amplifying the rounding of the term arguments, and a smaller _reseed
+    //   barely lowers it.
+    //
+    static void sweep(
+                      BodyId planet,          // must be in the range SUN...NEPTUNE
+                      double cen0,            // first time in decimal centuries
+                      double dcen,            // step in decimal centuries
+                      unsigned n,             // number of samples
+                      double* _out,           // [out] 3 x n values: lon, lat, rad for each sample
+                      unsigned _reseed = 256 );
 };  // end class Vsop
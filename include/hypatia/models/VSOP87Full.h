@@ -0,0 +1,93 @@
+/*****************************************************************************\
+ * VSOP87Full.h
+ *
+ * Complete VSOP87 series (version B or D) loaded at runtime from a binary
+ * file made by data/create_vsop87.py from the IMCCE distribution files.
+ *
+ * The file is memory-mapped and read in place (no copy): each planet's
+ * series start on their own page, so only the planets that are evaluated
+ * get paged in. The truncated tables compiled into VSOP87 stay the default,
+ * this is for runs that need the full precision of the theory.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "VSOP87.h"
+#include "MappedFile.h"
+
+#include <stdint.h>
+#include <string>
+
+// File header, all fields in native byte order
+struct VSOP87FileHeader {
+    char        magic[8];       // "HYPVSOP\0"
+    uint32_t    version;        // VSOP87Full::VERSION
+    uint32_t    endian;         // 0x01020304 as written by the converter
+    uint32_t    planets;        // number of VSOP87FilePlanet records that follow
+    char        theory;         // 'B' (J2000 ecliptic) or 'D' (ecliptic of date)
+    char        reserved[3];
+};
+
+// Per planet record. The planet's block starts at offset (page aligned) and holds,
+// for each location (lon, lat, rad) and power of t (0...5), A[rows], B[rows] and C[rows]
+struct VSOP87FilePlanet {
+    int32_t     id;             // BodyId
+    uint32_t    rows[3][6];     // number of terms of each series
+    uint32_t    reserved;
+    uint64_t    offset;         // byte offset of the block from the start of the file
+    uint64_t    bytes;          // size of the block
+};
+
+class VSOP87Full {
+public:
+    static const uint32_t VERSION;
+
+    VSOP87Full();
+    VSOP87Full( const std::string& _filename );
+    virtual ~VSOP87Full();
+
+    /**
+     * load() - map a file written by data/create_vsop87.py
+     *
+     * @throws Exception if the file can't be opened or is not a valid series file of this VERSION
+     */
+    virtual void        load( const std::string& _filename );
+    virtual void        close();
+
+    virtual bool        isLoaded() const { return m_file.isOpen(); }
+    virtual char        getTheory() const { return m_theory; }
+    virtual bool        have( BodyId _planet ) const;
+
+    // return the spec'd series, pointing into the mapped file (empty if not loaded)
+    //
+    virtual const VSOP87Series& getSeries(
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          VSOP87::LocType value,  // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          int power) const;       // power of t the series is multiplied by (0...5)
+
+    // same as VSOP87::calcLoc() with the complete series
+    //
+    virtual double      calcLoc(
+                          double cen,             // time in decimal centuries
+                          BodyId planet,          // must be in the range MERCURY...NEPTUNE
+                          VSOP87::LocType value,  // 0=ecliptic lon, 1=ecliptic lat, 2=radius
+                          VSOP87::Kernel _kernel = VSOP87::getKernel() ) const;
+
+    virtual void        calcAllLocs(
+                            double& lon,            // returned longitude
+                            double& lat,            // returned latitude
+                            double& rad,            // returned radius vector
+                            double cen,             // time in decimal centuries
+                            BodyId planet) const    // must be in the range MERCURY...NEPTUNE
+    {
+        lon = calcLoc( cen, planet, VSOP87::ECLIPTIC_LON );
+        lat = calcLoc( cen, planet, VSOP87::ECLIPTIC_LAT );
+        rad = calcLoc( cen, planet, VSOP87::RADIUS );
+    }
+
+protected:
+    MappedFile      m_file;
+    VSOP87Series    m_series[NEPTUNE + 1][3][6];
+    char            m_theory;
+};
@@ -0,0 +1,150 @@
+/*****************************************************************************\
+ * Core.h
+ *
+ * Plain value types behind Vector3, Matrix3x3, Equatorial, Ecliptic,
+ * Horizontal, Geodetic, TimeSpan and DateTime. They have no virtual
+ * functions, are trivially copyable and all their arithmetic is inline
+ * (constexpr where the math allows it), so the compiler can keep them in
+ * registers and vectorize loops over arrays of them.
+ *
+ * The classes above stay as the public API and convert to and from these
+ * with getCore() and a constructor. Hot paths work on the core types.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <type_traits>
+
+namespace hypatia {
+
+//---------------------------------------------------------------------------- vec3
+
+struct vec3 final {
+    double x, y, z;
+};
+
+constexpr vec3 operator+ (const vec3& _a, const vec3& _b) { return vec3{ _a.x + _b.x, _a.y + _b.y, _a.z + _b.z }; }
+constexpr vec3 operator- (const vec3& _a, const vec3& _b) { return vec3{ _a.x - _b.x, _a.y - _b.y, _a.z - _b.z }; }
+constexpr vec3 operator* (const vec3& _a, const vec3& _b) { return vec3{ _a.x * _b.x, _a.y * _b.y, _a.z * _b.z }; }
+constexpr vec3 operator/ (const vec3& _a, const vec3& _b) { return vec3{ _a.x / _b.x, _a.y / _b.y, _a.z / _b.z }; }
+constexpr vec3 operator* (const vec3& _a, double _d) { return vec3{ _a.x * _d, _a.y * _d, _a.z * _d }; }
+constexpr vec3 operator/ (const vec3& _a, double _d) { return vec3{ _a.x / _d, _a.y / _d, _a.z / _d }; }
+constexpr vec3 operator- (const vec3& _a) { return vec3{ -_a.x, -_a.y, -_a.z }; }
+
+constexpr double dot( const vec3& _a, const vec3& _b ) { return (_a.x * _b.x) + (_a.y * _b.y) + (_a.z * _b.z); }
+constexpr vec3 cross( const vec3& _a, const vec3& _b ) {
+    return vec3{ _a.y * _b.z - _a.z * _b.y, _a.z * _b.x - _a.x * _b.z, _a.x * _b.y - _a.y * _b.x };
+}
+
+inline double length( const vec3& _v ) { return sqrt(_v.x * _v.x + _v.y * _v.y + _v.z * _v.z); }
+
+inline vec3 normalize( const vec3& _v ) {
+    double l = length(_v);
+    return (l > 0.0) ? vec3{ _v.x / l, _v.y / l, _v.z / l } : vec3{ 0.0, 0.0, 0.0 };
+}
+
+// unit vector of spherical angles (radians), same as Vector3( Polar )
+inline vec3 fromPolar( double _phi, double _theta ) {
+    const double cosTheta = cos(_theta);
+    return vec3{ cos(_phi) * cosTheta, sin(_phi) * cosTheta, sin(_theta) };
+}
+
+// spherical angles (radians) of a vector, same as Vector3::getLongitude() / getLatitude()
+inline double toPhi( const vec3& _v ) { return atan2(_v.y, _v.x); }
+inline double toTheta( const vec3& _v ) { return atan2(_v.z, sqrt(_v.x * _v.x + _v.y * _v.y)); }
+
+//---------------------------------------------------------------------------- mat3
+
+// row major, same layout as Matrix3x3
+struct mat3 final {
+    double m[3][3];
+};
+
+constexpr vec3 operator* ( const mat3& _m, const vec3& _v ) {
+    return vec3{    _m.m[0][0] * _v.x + _m.m[0][1] * _v.y + _m.m[0][2] * _v.z,
+                    _m.m[1][0] * _v.x + _m.m[1][1] * _v.y + _m.m[1][2] * _v.z,
+                    _m.m[2][0] * _v.x + _m.m[2][1] * _v.y + _m.m[2][2] * _v.z };
+}
+
+// transpose( _m ) * _v without building the transpose
+constexpr vec3 mulTransposed( const mat3& _m, const vec3& _v ) {
+    return vec3{    _m.m[0][0] * _v.x + _m.m[1][0] * _v.y + _m.m[2][0] * _v.z,
+                    _m.m[0][1] * _v.x + _m.m[1][1] * _v.y + _m.m[2][1] * _v.z,
+                    _m.m[0][2] * _v.x + _m.m[1][2] * _v.y + _m.m[2][2] * _v.z };
+}
+
+constexpr mat3 transpose( const mat3& _m ) {
+    return mat3{{   { _m.m[0][0], _m.m[1][0], _m.m[2][0] },
+                    { _m.m[0][1], _m.m[1][1], _m.m[2][1] },
+                    { _m.m[0][2], _m.m[1][2], _m.m[2][2] } }};
+}
+
+inline mat3 operator* ( const mat3& _a, const mat3& _b ) {
+    mat3 r;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            r.m[i][j] = _a.m[i][0] * _b.m[0][j] + _a.m[i][1] * _b.m[1][j] + _a.m[i][2] * _b.m[2][j];
+    return r;
+}
+
+//---------------------------------------------------------------------------- coordinates
+
+// angles in radians, distances as noted
+struct eq_coord final {
+    double ra, dec;
+};
+
+struct ecl_coord final {
+    double lng, lat;
+    double radius;      // AU
+};
+
+struct hor_coord final {
+    double alt, az;
+};
+
+struct geo_coord final {
+    double lng, lat;
+    double alt;         // KM
+};
+
+inline vec3 toVector( const eq_coord& _e ) { return fromPolar(_e.ra, _e.dec); }
+inline vec3 toVector( const ecl_coord& _e ) { return fromPolar(_e.lng, _e.lat) * _e.radius; }
+
+inline eq_coord toEquatorial( const vec3& _v ) { return eq_coord{ toPhi(_v), toTheta(_v) }; }
+inline ecl_coord toEcliptic( const vec3& _v ) { return ecl_coord{ toPhi(_v), toTheta(_v), length(_v) }; }
+
+//---------------------------------------------------------------------------- time
+
+// ticks of TimeSpan::TICKS_PER_SECOND
+struct time_span final {
+    int64_t ticks;
+};
+
+struct date_time final {
+    int64_t ticks;
+};
+
+constexpr time_span operator+ ( const time_span& _a, const time_span& _b ) { return time_span{ _a.ticks + _b.ticks }; }
+constexpr time_span operator- ( const time_span& _a, const time_span& _b ) { return time_span{ _a.ticks - _b.ticks }; }
+constexpr date_time operator+ ( const date_time& _a, const time_span& _b ) { return date_time{ _a.ticks + _b.ticks }; }
+constexpr date_time operator- ( const date_time& _a, const time_span& _b ) { return date_time{ _a.ticks - _b.ticks }; }
+constexpr time_span operator- ( const date_time& _a, const date_time& _b ) { return time_span{ _a.ticks - _b.ticks }; }
+
+constexpr bool operator== ( const time_span& _a, const time_span& _b ) { return _a.ticks == _b.ticks; }
+constexpr bool operator<  ( const time_span& _a, const time_span& _b ) { return _a.ticks < _b.ticks; }
+constexpr bool operator== ( const date_time& _a, const date_time& _b ) { return _a.ticks == _b.ticks; }
+constexpr bool operator<  ( const date_time& _a, const date_time& _b ) { return _a.ticks < _b.ticks; }
+
+static_assert( std::is_trivially_copyable<vec3>::value && sizeof(vec3) == 3 * sizeof(double), "vec3 must be a plain triple" );
+static_assert( std::is_trivially_copyable<mat3>::value && sizeof(mat3) == 9 * sizeof(double), "mat3 must be a plain 3x3 array" );
+static_assert( std::is_trivially_copyable<eq_coord>::value, "eq_coord must be trivially copyable" );
+static_assert( std::is_trivially_copyable<ecl_coord>::value, "ecl_coord must be trivially copyable" );
+static_assert( std::is_trivially_copyable<hor_coord>::value, "hor_coord must be trivially copyable" );
+static_assert( std::is_trivially_copyable<geo_coord>::value, "geo_coord must be trivially copyable" );
+static_assert( std::is_trivially_copyable<date_time>::value, "date_time must be trivially copyable" );
+
+}
@@ -14,7 +14,10 @@ public:
     DateTime(unsigned int _year, double _DoY);
     DateTime(int _year, int _month, int _day);
     DateTime(int _year, int _month, int _day, int _hour, int _minute, int _second);
+    DateTime(const hypatia::date_time& _core) : m_encoded(_core.ticks) {}
     virtual ~DateTime();
+
+    hypatia::date_time getCore() const { return hypatia::date_time{ m_encoded }; }
     
     virtual TimeSpan getTimeOfDay() const;
     virtual int64_t getTicks() const;
@@ -12,7 +12,15 @@ public:
 
     Matrix3x3(Vector3& _v0, Vector3& _v1, Vector3& _v2);
     Matrix3x3(const Matrix3x3& _m);
+    Matrix3x3(const hypatia::mat3& _m) { setData(&_m.m[0][0]); }
     virtual ~Matrix3x3();
+
+    // plain value copy for the inlined math of Core.h
+    hypatia::mat3   getCore() const {
+        return hypatia::mat3{{  { m_data[0][0], m_data[0][1], m_data[0][2] },
+                                { m_data[1][0], m_data[1][1], m_data[1][2] },
+                                { m_data[2][0], m_data[2][1], m_data[2][2] } }};
+    }
     
     static      Matrix3x3 transpose(const Matrix3x3& _m);
     static      Matrix3x3 rotationX(const double _radians);
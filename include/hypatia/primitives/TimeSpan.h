@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include "Core.h"
 #include <iomanip>
 
 /**
@@ -16,7 +17,10 @@ public:
     TimeSpan(int hours, int minutes, int seconds);
     TimeSpan(int days, int hours, int minutes, int seconds);
     TimeSpan(int days, int hours, int minutes, int seconds, int microseconds);
+    TimeSpan(const hypatia::time_span& _core) : m_ticks(_core.ticks) {}
     virtual ~TimeSpan();
+
+    hypatia::time_span getCore() const { return hypatia::time_span{ m_ticks }; }
     
     virtual TimeSpan operator+ (const TimeSpan& _ts) const;
     virtual TimeSpan operator- (const TimeSpan& _ts) const;
@@ -1,14 +1,19 @@
 #pragma once
 
 #include "Polar.h"
+#include "Core.h"
 
 class Vector3 {
 public:
     Vector3();
     Vector3(const Polar& _polar);
     Vector3(const double _x, const double _y, const double _z);
+    Vector3(const hypatia::vec3& _v) : x(_v.x), y(_v.y), z(_v.z) {}
     
     virtual ~Vector3();
+
+    // plain value copy for the inlined math of Core.h
+    hypatia::vec3   getCore() const { return hypatia::vec3{ x, y, z }; }
     
     double x, y, z;
 
@@ -35,13 +35,24 @@ hypatia_module = Extension(
     'src/CoordOps.cpp',
     'src/GeoOps.cpp',
     'src/ProjOps.cpp',
+    'src/EventOps.cpp',
+    'src/EpochContext.cpp',
     'src/Observer.cpp', 
+    'src/ObserverState.cpp',
     'src/Body.cpp', 
     'src/Luna.cpp', 
+    'src/SolarSystemSnapshot.cpp',
+    'src/ObserverGroup.cpp',
     'src/Star.cpp',
+    'src/StarIndex.cpp',
     'src/Constellation.cpp',
     'src/Satellite.cpp',
     'src/models/VSOP87.cpp',
+    'src/models/VSOP87Simd.cpp',
+    'src/models/VSOP87Sweep.cpp',
+    'src/models/MappedFile.cpp',
+    'src/models/VSOP87Full.cpp',
+    'src/models/ChebyshevEphemeris.cpp',
     'src/models/Pluto.cpp',
     'src/models/TLE.cpp',
     'src/models/Orbit.cpp',
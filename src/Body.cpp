@@ -11,11 +11,16 @@
 #include "hypatia/Body.h"
 
 #include "hypatia/CoordOps.h"
+#include "hypatia/SolarSystemSnapshot.h"
 
 #include "hypatia/Luna.h"
 #include "hypatia/models/Pluto.h"
 #include "hypatia/models/VSOP87.h"
 
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
 static char* bodyNames[] = { (char*)"Sun", (char*)"Mercury", (char*)"Venus", (char*)"Earth", (char*)"Mars", (char*)"Jupiter", (char*)"Saturn", (char*)"Uranus", (char*)"Neptune", (char*)"Pluto", (char*)"Luna", (char*)"Satellite" };
 
 static char* zodiacSigns[] = { (char*)"Ari", (char*)"Taurus", (char*)"Gemini", (char*)"Cancer", (char*)"Leo", (char*)"Virgo", (char*)"Libra", (char*)"Scorpion", (char*)"Sagittarius", (char*)"Capricorn", (char*)"Aquarius", (char*)"Pisces" };
@@ -23,10 +28,10 @@ static char* zodiacSigns[] = { (char*)"Ari", (char*)"Taurus", (char*)"Gemini", (
 //                         Sun,  Mercury, Venus, Earth,  Mars, Jupiter, Saturn, Uranus, Neptune, Pluto,   Moon, Sats
 static double period[] = { 0.0, 0.240846, 0.615,   1.0, 1.881,   11.86,  29.46,  84.01,   164.8, 248.1, 0.0751,  0.0 };
 
-Body::Body() : m_jcentury(0.0), m_ha(0.0), m_bodyId(NAB), m_retrograde(false) {
+Body::Body() : m_jcentury(0.0), m_ha(0.0), m_bodyId(NAB), m_timeVersion(0), m_locationVersion(0), m_bVelocity(false) {
 }
 
-Body::Body( BodyId _body ) : m_jcentury(0.0), m_ha(0.0), m_bodyId(_body), m_retrograde(false) {
+Body::Body( BodyId _body ) : m_jcentury(0.0), m_ha(0.0), m_bodyId(_body), m_timeVersion(0), m_locationVersion(0), m_bVelocity(false) {
 }
 
 Body::~Body() {
@@ -64,17 +69,38 @@ double Body::getPeriod(TIME_UNIT _unit) const {
  * Body::isRetrograde() - determine whether this body is currently moving
  *                        retrograde (westward along the ecliptic).
  *
- * Computes the body's geocentric ecliptic longitude both at the current JD
- * and 1 hour earlier, then checks whether the longitude decreased.
- * Not applicable for SUN or LUNA (always returns false for these).
- *
- * Note: creates a temporary Observer and Body on every call; this is not
- * performance-critical since retrograde detection is rarely needed every frame.
+ * Uses the sign of the geocentric longitude rate at the computed JD, so it
+ * doesn't depend on previous computations.
+ * Not applicable for SUN, EARTH or LUNA (always returns false for these).
  *
  * @return true if the body is moving retrograde, false otherwise
  */
 bool Body::isRetrograde() const {
-    return m_retrograde;
+    if (m_bodyId == SUN || m_bodyId == EARTH || m_bodyId == LUNA)
+        return false;
+
+    return CoordOps::toLongitudeRate(m_geocentric.getVector(AU), getEclipticVelocity(AU)) < 0.0;
+}
+
+/**
+ * Body::getEclipticVelocity() - rectangular geocentric ecliptic velocity
+ *
+ * Derived analytically from the series of each model (VSOP87, Pluto, ELP2000).
+ * compute() doesn't evaluate it, it is computed on the first call after it.
+ *
+ * @param _type - distance unit of the result
+ *
+ * @return velocity in _type per day
+ */
+Vector3 Body::getEclipticVelocity(DISTANCE_UNIT _type) const {
+    if ( !m_bVelocity ) {
+        computeVelocity();
+    }
+
+    if ( _type == AU ) {
+        return m_eclipticVelocity;
+    }
+    return Ecliptic(m_eclipticVelocity, AU).getVector(_type);
 }
 
 /**
@@ -90,11 +116,12 @@ bool Body::isRetrograde() const {
  * For the SUN, the VSOP87 result gives the Earth as seen from the Sun;
  * to get the Sun as seen from Earth: longitude += PI, latitude = -latitude.
  *
- * Computed quantities (always updated on each call due to commented-out
- * JC guard -- uncomment the guard to enable caching):
+ * Computed quantities, by stage:
+ *   time stage (only when the observer's time changed):
  *   - m_heliocentric : ecliptic heliocentric position
  *   - m_geocentric   : ecliptic geocentric position
  *   - m_equatorial   : equatorial RA/Dec
+ *   location stage (when the observer's time or location changed):
  *   - m_horizontal   : altitude/azimuth (only when observer has a location)
  *   - m_ha           : hour angle (radians)
  *
@@ -105,19 +132,12 @@ void Body::compute( Observer& _obs ) {
     // is the last one (AltAzLoc), which depends on all the previous
     // calculations
     //
-    if (m_jcentury != _obs.getJC()) {
-        double prevJC  = m_jcentury;
-        double prevLng = (m_bodyId != SUN && m_bodyId != LUNA) ? m_geocentric.getLongitude(RADS) : 0.0;
-        m_jcentury = _obs.getJC();
-
+    if (syncTime(_obs)) {
         // choose appropriate method, based on planet
         //
         if (LUNA == m_bodyId) {       /* not VSOP */   
-            static Luna luna;
-            luna.compute(_obs);
-            m_geocentric = luna.getEclipticGeocentric();
-            m_heliocentric = luna.getEclipticHeliocentric();
-            
+            m_geocentric = Luna::computeGeocentric(m_jcentury);
+            m_heliocentric = CoordOps::toHeliocentric(_obs, m_geocentric);
         }
         else if (PLUTO == m_bodyId) {    /* not VSOP */
             double hLng, hLat, rad = 0.0;
@@ -151,27 +171,480 @@ void Body::compute( Observer& _obs ) {
         }
         
         m_equatorial = CoordOps::toEquatorial( _obs, m_geocentric );
-        
-        if ( _obs.haveLocation() ) {
-            m_ha = MathOps::normalize(CoordOps::toHourAngle( _obs, m_equatorial ), RADS);
-            m_horizontal = CoordOps::toHorizontal( _obs, m_equatorial );
-            m_bHorizontal = true;
+        m_bVelocity = false;
+    }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+/**
+ * Body::compute() - same as compute( Observer& ) but reading the ecliptic and
+ *                   equatorial positions from a precomputed SolarSystemSnapshot.
+ *
+ * Only the observer dependent quantities (hour angle and horizontal
+ * coordinates) are evaluated. Falls back to compute( Observer& ) when the
+ * snapshot was taken at a different JD or doesn't cover this body.
+ *
+ * @param _obs      - Observer carrying JD, location and LST
+ * @param _snapshot - snapshot computed at the observer's JD
+ */
+void Body::compute( Observer& _obs, const SolarSystemSnapshot& _snapshot ) {
+    if ( _snapshot.getJD() != _obs.getJD() || !_snapshot.have(m_bodyId) ) {
+        compute(_obs);
+        return;
+    }
+
+    if (syncTime(_obs)) {
+        m_heliocentric = _snapshot.getEclipticHeliocentric(m_bodyId);
+        m_geocentric = _snapshot.getEclipticGeocentric(m_bodyId);
+        m_eclipticVelocity = _snapshot.getEclipticVelocity(m_bodyId);
+        m_bVelocity = true;
+        m_equatorial = _snapshot.getEquatorial(m_bodyId);
+    }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+/**
+ * Body::compute() - same as compute( Observer& ) but reading the epoch
+ *                   dependent quantities (Earth's heliocentric position and
+ *                   velocity, obliquity) from a shared EpochContext, so the
+ *                   Earth series are not evaluated again for every body.
+ *
+ * Falls back to compute( Observer& ) when the context is for a different JD.
+ *
+ * @param _obs   - Observer carrying JD, location and LST
+ * @param _epoch - context computed at the observer's JD
+ */
+void Body::compute( Observer& _obs, const EpochContext& _epoch ) {
+    if ( _epoch.getJD() != _obs.getJD() ) {
+        compute(_obs);
+        return;
+    }
+
+    if (syncTime(_obs)) {
+        if (LUNA == m_bodyId) {
+            m_geocentric = Luna::computeGeocentric(m_jcentury);
+            m_heliocentric = CoordOps::toHeliocentric(_epoch, m_geocentric);
+        }
+        else if (SUN == m_bodyId) {
+            Ecliptic earth = _epoch.getEarthHeliocentric();
+            m_heliocentric = earth;
+            m_geocentric = Ecliptic(earth.getLongitude(RADS) + MathOps::PI, earth.getLatitude(RADS) * -1., earth.getRadius(AU), RADS, AU);
+        }
+        else if (EARTH == m_bodyId) {
+            m_heliocentric = _epoch.getEarthHeliocentric();
+            m_geocentric = Ecliptic(0., 0., 0., RADS, AU);
+        }
+        else {
+            double hLng, hLat, rad = 0.0;
+            if (PLUTO == m_bodyId)
+                Pluto::calcAllLocs(hLng, hLat, rad, m_jcentury);
+            else
+                VSOP87::calcAllLocs(hLng, hLat, rad, m_jcentury, m_bodyId);
+            m_heliocentric = Ecliptic(hLng, hLat, rad, RADS, AU);
+            m_geocentric = CoordOps::toGeocentric(_epoch, m_heliocentric);
+        }
+
+        m_equatorial = CoordOps::toEquatorial( _epoch, m_geocentric );
+        m_bVelocity = false;
+    }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+/**
+ * Body::compute() - same as compute( Observer& ) from an immutable ObserverState.
+ *
+ * Earth's heliocentric position and velocity, the obliquity and the sidereal
+ * time are read from the state, which is never modified, so several threads
+ * can compute their own bodies from the same state.
+ *
+ * @param _state - state of the observer
+ */
+void Body::compute( const ObserverState& _state ) {
+    if (syncTime(_state)) {
+        if (LUNA == m_bodyId) {
+            m_geocentric = Luna::computeGeocentric(m_jcentury);
+            m_heliocentric = CoordOps::toHeliocentric(_state, m_geocentric);
+        }
+        else if (SUN == m_bodyId) {
+            Ecliptic earth = _state.getEarthHeliocentric();
+            m_heliocentric = earth;
+            m_geocentric = Ecliptic(earth.getLongitude(RADS) + MathOps::PI, earth.getLatitude(RADS) * -1., earth.getRadius(AU), RADS, AU);
+        }
+        else if (EARTH == m_bodyId) {
+            m_heliocentric = _state.getEarthHeliocentric();
+            m_geocentric = Ecliptic(0., 0., 0., RADS, AU);
+        }
+        else {
+            double hLng, hLat, rad = 0.0;
+            if (PLUTO == m_bodyId)
+                Pluto::calcAllLocs(hLng, hLat, rad, m_jcentury);
+            else
+                VSOP87::calcAllLocs(hLng, hLat, rad, m_jcentury, m_bodyId);
+            m_heliocentric = Ecliptic(hLng, hLat, rad, RADS, AU);
+            m_geocentric = CoordOps::toGeocentric(_state, m_heliocentric);
+        }
+
+        m_equatorial = CoordOps::toEquatorial( _state, m_geocentric );
+        m_bVelocity = false;
+    }
+
+    if (syncLocation(_state))
+        computeHorizontal(_state);
+}
+
+/**
+ * Body::syncTime() - check the time stage of compute() against the observer
+ *
+ * When the observer's time changed, marks the time stage current for it (and the
+ * location stage stale, since the hour angle follows the equatorial position)
+ *
+ * @param _obs - Observer
+ *
+ * @return true if the time stage has to be computed
+ */
+bool Body::syncTime( const Observer& _obs ) {
+    if (m_timeVersion == _obs.getTimeVersion())
+        return false;
+
+    m_timeVersion = _obs.getTimeVersion();
+    m_locationVersion = 0;
+    m_jcentury = _obs.getJC();
+    return true;
+}
+
+/**
+ * Body::syncLocation() - check the location stage of compute() against the observer
+ *
+ * @param _obs - Observer
+ *
+ * @return true if the location stage has to be computed
+ */
+bool Body::syncLocation( const Observer& _obs ) {
+    if (m_locationVersion == _obs.getLocationVersion())
+        return false;
+
+    m_locationVersion = _obs.getLocationVersion();
+    return true;
+}
+
+// same as above, the state carries the versions of the Observer it was taken from
+bool Body::syncTime( const ObserverState& _state ) {
+    if (m_timeVersion == _state.getTimeVersion())
+        return false;
+
+    m_timeVersion = _state.getTimeVersion();
+    m_locationVersion = 0;
+    m_jcentury = _state.getJC();
+    return true;
+}
+
+bool Body::syncLocation( const ObserverState& _state ) {
+    if (m_locationVersion == _state.getLocationVersion())
+        return false;
+
+    m_locationVersion = _state.getLocationVersion();
+    return true;
+}
+
+/**
+ * Body::computeHorizontal() - hour angle and horizontal coordinates of the
+ *                             current equatorial position.
+ *
+ * If the observer has no location both are reset to 0.0.
+ *
+ * @param _obs - Observer carrying location and LST
+ */
+void Body::computeHorizontal( Observer& _obs ) {
+    if ( _obs.haveLocation() ) {
+        m_ha = MathOps::normalize(CoordOps::toHourAngle( _obs, m_equatorial ), RADS);
+        m_horizontal = CoordOps::toHorizontal( _obs, m_equatorial );
+        m_bHorizontal = true;
+    }
+    else {
+        m_ha = 0.0;
+        m_horizontal[0] = 0.0;
+        m_horizontal[1] = 0.0;
+        m_bHorizontal = false;
+    }
+}
+
+void Body::computeHorizontal( const ObserverState& _state ) {
+    if ( _state.haveLocation() ) {
+        m_ha = MathOps::normalize(CoordOps::toHourAngle( _state, m_equatorial ), RADS);
+        m_horizontal = CoordOps::toHorizontal( _state, m_equatorial );
+        m_bHorizontal = true;
+    }
+    else {
+        m_ha = 0.0;
+        m_horizontal[0] = 0.0;
+        m_horizontal[1] = 0.0;
+        m_bHorizontal = false;
+    }
+}
+
+/**
+ * Body::computeVelocity() - geocentric ecliptic velocity at the last computed
+ *                           time, from the rates of the series of each model.
+ *
+ * Kept out of compute() so the per frame path only pays for positions. Earth's
+ * velocity is taken from VSOP87 at the same time, so the result doesn't depend
+ * on which compute() overload was used.
+ */
+void Body::computeVelocity() const {
+    if (LUNA == m_bodyId) {
+        m_eclipticVelocity = Luna::computeGeocentricVelocity(m_jcentury, m_geocentric);
+    }
+    else if (EARTH == m_bodyId || SATELLITE == m_bodyId || NAB == m_bodyId) {
+        m_eclipticVelocity = Vector3(0., 0., 0.);
+    }
+    else {
+        double hLng, hLat, rad = 0.0;
+        double dLng, dLat, dRad = 0.0;
+        VSOP87::calcAllLocsAndRates(hLng, hLat, rad, dLng, dLat, dRad, m_jcentury, EARTH);
+        Vector3 earth = CoordOps::toEclipticVelocity(Ecliptic(hLng, hLat, rad, RADS, AU), dLng, dLat, dRad);
+
+        if (SUN == m_bodyId) {
+            m_eclipticVelocity = earth * -1.;
+        }
+        else {
+            if (PLUTO == m_bodyId)
+                Pluto::calcAllLocsAndRates(hLng, hLat, rad, dLng, dLat, dRad, m_jcentury);
+            else
+                VSOP87::calcAllLocsAndRates(hLng, hLat, rad, dLng, dLat, dRad, m_jcentury, m_bodyId);
+            m_eclipticVelocity = CoordOps::toEclipticVelocity(m_heliocentric, dLng, dLat, dRad) - earth;
+        }
+    }
+    m_bVelocity = true;
+}
+
+/**
+ * Body::rangeSamples() - fill the coordinates of computeRange() samples from
+ *                        already evaluated positions, as compute() would.
+ *
+ * Works on plain arrays only, no coordinate objects are made per sample.
+ *
+ * @param _id    - body
+ * @param _obs   - observer, for the location
+ * @param _loc   - 3 x n heliocentric lng, lat, rad of the body (geocentric for LUNA and SATELLITE)
+ * @param _earth - 3 x n heliocentric lng, lat, rad of the Earth
+ * @param _n     - number of samples
+ * @param _out   - samples, with jd already set
+ */
+void Body::rangeSamples( BodyId _id, const Observer& _obs, const double* _loc, const double* _earth, size_t _n, Sample* _out ) {
+    const bool haveLocation = _obs.haveLocation();
+    double lng = 0.0, sl = 0.0, cl = 1.0;
+    if (haveLocation) {
+        Geodetic location = _obs.getLocation();
+        lng = location.getLongitude(RADS);
+        sl = sin(location.getLatitude(RADS));
+        cl = cos(location.getLatitude(RADS));
+    }
+
+    for (size_t k = 0; k < _n; k++) {
+        Sample& s = _out[k];
+        const double* e = _earth + 3 * k;
+        const double* l = _loc + 3 * k;
+
+        // Earth's heliocentric rectangular position
+        double ecb = cos(e[1]);
+        double ex = cos(e[0]) * ecb * e[2];
+        double ey = sin(e[0]) * ecb * e[2];
+        double ez = sin(e[1]) * e[2];
+
+        if (SUN == _id) {
+            s.hLng = e[0]; s.hLat = e[1]; s.hRad = e[2];
+            s.gLng = e[0] + MathOps::PI; s.gLat = e[1] * -1.; s.gRad = e[2];
+        }
+        else if (EARTH == _id) {
+            s.hLng = e[0]; s.hLat = e[1]; s.hRad = e[2];
+            s.gLng = 0.0; s.gLat = 0.0; s.gRad = 0.0;
+        }
+        else if (LUNA == _id || SATELLITE == _id) {
+            s.gLng = l[0]; s.gLat = l[1]; s.gRad = l[2];
+            double cb = cos(l[1]);
+            double x = ex + cos(l[0]) * cb * l[2];
+            double y = ey + sin(l[0]) * cb * l[2];
+            double z = ez + sin(l[1]) * l[2];
+            s.hLng = atan2(y, x);
+            s.hLat = atan2(z, sqrt(x * x + y * y));
+            s.hRad = sqrt(x * x + y * y + z * z);
         }
         else {
-            m_ha = 0.0;
-            m_horizontal[0] = 0.0;
-            m_horizontal[1] = 0.0;
-            m_bHorizontal = false;
+            s.hLng = l[0]; s.hLat = l[1]; s.hRad = l[2];
+            double cb = cos(l[1]);
+            double x = cos(l[0]) * cb * l[2] - ex;
+            double y = sin(l[0]) * cb * l[2] - ey;
+            double z = sin(l[1]) * l[2] - ez;
+            s.gLng = atan2(y, x);
+            s.gLat = atan2(z, sqrt(x * x + y * y));
+            s.gRad = sqrt(x * x + y * y + z * z);
         }
 
-        // Cache retrograde status using consecutive-longitude comparison (no extra allocations)
-        if (m_bodyId != SUN && m_bodyId != LUNA && prevJC != 0.0) {
-            double currLng = m_geocentric.getLongitude(RADS);
-            double diff = currLng - prevLng;
-            while (diff <= -MathOps::PI) diff += MathOps::TAU;
-            while (diff > MathOps::PI)  diff -= MathOps::TAU;
-            double dt = m_jcentury - prevJC;
-            m_retrograde = (dt > 0.0) ? (diff < 0.0) : (diff > 0.0);
+        // ecliptic to equatorial, as CoordOps::toEquatorial()
+        const double jc = TimeOps::toJC(s.jd);
+        const double obliq = CoordOps::meanObliquity(jc);
+        const double so = sin(obliq);
+        const double co = cos(obliq);
+        const double sgl = sin(s.gLng);
+        s.ra = atan2((sgl * co - tan(s.gLat) * so), cos(s.gLng));
+        s.dec = asin(sin(s.gLat) * co + cos(s.gLat) * so * sgl);
+        if (s.ra < 0)
+            s.ra += MathOps::TAU;
+
+        // equatorial to horizontal, as CoordOps::toHorizontal()
+        if (haveLocation) {
+            double ha = TimeOps::toGreenwichSiderealTime(s.jd) + lng - s.ra;
+            double sd = sin(s.dec);
+            double alt = asin(sd * sl + cos(s.dec) * cl * cos(ha));
+            double az = acos( MathOps::clamp((sd - sin(alt) * sl) / (cos(alt) * cl), -1.0, 1.0) );
+            if (sin(ha) > 0.0)
+                az = MathOps::TAU - az;
+
+            s.ha = MathOps::normalize(ha, RADS);
+            s.alt = alt;
+            s.az = az;
+        }
+        else {
+            s.ha = 0.0;
+            s.alt = 0.0;
+            s.az = 0.0;
         }
     }
+}
+
+/**
+ * Body::getRangeSize() - number of samples of computeRange()
+ *
+ * @param _jdStart - first julian day
+ * @param _jdEnd   - last julian day (included when it falls on a step)
+ * @param _step    - days between samples
+ *
+ * @return number of samples, 0 for an empty range or a non positive step
+ */
+size_t Body::getRangeSize( double _jdStart, double _jdEnd, double _step ) {
+    if (_step <= 0.0 || _jdEnd < _jdStart)
+        return 0;
+
+    // ( _jdEnd - _jdStart ) is only known to a few ulps of the julian days (~1e-10 days
+    // near J2000), so ranges ending on a step can fall short of it by that much
+    const double slack = 4.0 * DBL_EPSILON * std::max(fabs(_jdStart), fabs(_jdEnd)) / _step;
+    return (size_t)floor( (_jdEnd - _jdStart) / _step + slack ) + 1;
+}
+
+/**
+ * Body::computeRange() - positions at evenly spaced times
+ *
+ * Evaluates every sample's positions first and then the coordinate transforms
+ * over the whole range. For the VSOP87 bodies (and the Earth, needed by all)
+ * the series are evaluated with VSOP87::sweep(), which steps every term by
+ * rotation instead of calling cos() per term and sample, so the results can
+ * differ from compute() by up to 1e-12 (radians or AU) within a century of
+ * J2000, and 2e-11 within ten.
+ *
+ * The body's own state is not touched.
+ *
+ * @param _obs     - location of the observer (its JD is not used)
+ * @param _jdStart - first julian day
+ * @param _jdEnd   - last julian day
+ * @param _step    - days between samples
+ * @param _out     - room for getRangeSize( _jdStart, _jdEnd, _step ) samples
+ *
+ * @return number of samples written, 0 for bodies without a model here
+ *         (NAB, and SATELLITE unless it is a Satellite)
+ */
+size_t Body::computeRange( const Observer& _obs, double _jdStart, double _jdEnd, double _step, Sample* _out ) const {
+    const size_t n = getRangeSize(_jdStart, _jdEnd, _step);
+    if (n == 0 || NAB == m_bodyId || SATELLITE == m_bodyId)
+        return 0;
+
+    for (size_t k = 0; k < n; k++)
+        _out[k].jd = _jdStart + k * _step;
+
+    const double cen0 = TimeOps::toJC(_jdStart);
+    const double dcen = _step / TimeOps::DAYS_PER_CENTURY;
+
+    std::vector<double> earth(3 * n);
+    std::vector<double> loc(3 * n, 0.0);
+    VSOP87::sweep(EARTH, cen0, dcen, n, earth.data());
+
+    if (m_bodyId > SUN && m_bodyId < PLUTO && m_bodyId != EARTH) {
+        VSOP87::sweep(m_bodyId, cen0, dcen, n, loc.data());
+    }
+    else if (PLUTO == m_bodyId) {
+        for (size_t k = 0; k < n; k++)
+            Pluto::calcAllLocs(loc[3 * k], loc[3 * k + 1], loc[3 * k + 2], TimeOps::toJC(_out[k].jd));
+    }
+    else if (LUNA == m_bodyId) {
+        for (size_t k = 0; k < n; k++) {
+            Ecliptic geo = Luna::computeGeocentric( TimeOps::toJC(_out[k].jd) );
+            loc[3 * k] = geo.getLongitude(RADS);
+            loc[3 * k + 1] = geo.getLatitude(RADS);
+            loc[3 * k + 2] = geo.getRadius(AU);
+        }
+    }
+
+    rangeSamples(m_bodyId, _obs, loc.data(), earth.data(), n, _out);
+    return n;
+}
+
+/**
+ * Body::computeRange() - positions at explicit times
+ *
+ * Same as compute() at each of the julian days, evaluated in two passes
+ * (positions, then coordinate transforms) without touching the body's state.
+ *
+ * @param _obs   - location of the observer (its JD is not used)
+ * @param _jds   - julian days
+ * @param _count - number of julian days
+ * @param _out   - room for _count samples
+ *
+ * @return number of samples written, _count or 0 for bodies without a model here
+ */
+size_t Body::computeRange( const Observer& _obs, const double* _jds, size_t _count, Sample* _out ) const {
+    if (_count == 0 || NAB == m_bodyId || SATELLITE == m_bodyId)
+        return 0;
+
+    std::vector<double> earth(3 * _count);
+    std::vector<double> loc(3 * _count, 0.0);
+
+    for (size_t k = 0; k < _count; k++) {
+        const double jc = TimeOps::toJC(_jds[k]);
+        _out[k].jd = _jds[k];
+
+        VSOP87::calcAllLocs(earth[3 * k], earth[3 * k + 1], earth[3 * k + 2], jc, EARTH);
+
+        if (m_bodyId > SUN && m_bodyId < PLUTO && m_bodyId != EARTH) {
+            VSOP87::calcAllLocs(loc[3 * k], loc[3 * k + 1], loc[3 * k + 2], jc, m_bodyId);
+        }
+        else if (PLUTO == m_bodyId) {
+            Pluto::calcAllLocs(loc[3 * k], loc[3 * k + 1], loc[3 * k + 2], jc);
+        }
+        else if (LUNA == m_bodyId) {
+            Ecliptic geo = Luna::computeGeocentric(jc);
+            loc[3 * k] = geo.getLongitude(RADS);
+            loc[3 * k + 1] = geo.getLatitude(RADS);
+            loc[3 * k + 2] = geo.getRadius(AU);
+        }
+    }
+
+    rangeSamples(m_bodyId, _obs, loc.data(), earth.data(), _count, _out);
+    return _count;
+}
+
+std::vector<Body::Sample> Body::computeRange( const Observer& _obs, double _jdStart, double _jdEnd, double _step ) const {
+    std::vector<Sample> samples( getRangeSize(_jdStart, _jdEnd, _step) );
+    samples.resize( computeRange(_obs, _jdStart, _jdEnd, _step, samples.data()) );
+    return samples;
+}
+
+std::vector<Body::Sample> Body::computeRange( const Observer& _obs, const std::vector<double>& _jds ) const {
+    std::vector<Sample> samples( _jds.size() );
+    samples.resize( computeRange(_obs, _jds.data(), _jds.size(), samples.data()) );
+    return samples;
 }
\ No newline at end of file
@@ -4,6 +4,10 @@
 
 #include "hypatia/CoordOps.h"
 #include "hypatia/TimeOps.h"
+#include "hypatia/coordinates/PrecessionMatrix.h"
+
+#include "Lazy.h"
+#include "Parallel.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -11,6 +15,12 @@
 #include <ctype.h>
 #include <math.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+const double Constellation::EPOCH = 1875.0;
+
 /*
 ======================================================================
 Ernie Wright  2 Mar 94
@@ -890,12 +900,7 @@ pick point, rather than at the north pole.
 The data in cbound[] are for epoch 1875.
 ======================================================================
 */
-int getConstellationId( double _ra, double _dec ) {
-    unsigned short ra = ( unsigned short )( (_ra * MathOps::DEGS_TO_HRS) * 1800 );
-    short de = ( short )( _dec * 60 );
-    if (_dec < 0.0) {
-        --de;
-    }
+static int lookupConstellationId( unsigned short ra, short de ) {
     short i = ( de + 5400 ) / 300;
     if ( i < 0 || i > 36 ) {
         return -1;
@@ -911,6 +916,185 @@ int getConstellationId( double _ra, double _dec ) {
     return (i == N_BOUNDS)? -1 : (int)cbound[i].index;
 }
 
+int getConstellationId( double _ra, double _dec ) {
+    unsigned short ra = ( unsigned short )( (_ra * MathOps::DEGS_TO_HRS) * 1800 );
+    short de = ( short )( _dec * 60 );
+    if (_dec < 0.0) {
+        --de;
+    }
+    return lookupConstellationId( ra, de );
+}
+
+/*
+ * Lookup raster over the scaled coordinates of cbound[] ( RA in hours * 1800,
+ * Dec in degrees * 60 ). getConstellationId() only changes value where the
+ * RA crosses a lower_ra or upper_ra of cbound[], or the Dec a lower_dec, so a
+ * cell without any of them inside holds a single constellation and answers
+ * with one read. The few cells a boundary goes through fall back to the
+ * search, which keeps the result identical to getConstellationId().
+ */
+
+// cell size in scaled units: 0.25 degrees on each axis, about 5% of the cells hold a boundary
+static const int RASTER_RA = 30;
+static const int RASTER_DEC = 15;
+static const int RASTER_COLS = 43200 / RASTER_RA;
+static const int RASTER_ROWS = 10800 / RASTER_DEC;
+static const signed char RASTER_BOUNDARY = -2;
+
+// fewest points classified by a thread of their own
+static const size_t MIN_PER_THREAD = 65536;
+
+// positions precessed together, so the matrix product runs over plain arrays
+static const size_t BLOCK = 256;
+
+// precession matrices kept before the cache starts over
+static const size_t MAX_EPOCHS = 64;
+
+namespace {
+
+struct Raster {
+    signed char cells[RASTER_ROWS][RASTER_COLS];
+
+    Raster() {
+        // raBreaks[r] counts breakpoints in [1, r], a breakpoint b meaning the value may change from b - 1 to b
+        std::vector<int> raBreaks(43200 + 1, 0);
+        std::vector<int> decBreaks(10800 + 1, 0);
+        for (int i = 0; i < N_BOUNDS; i++) {
+            if (cbound[i].lower_ra < 43200)
+                raBreaks[ cbound[i].lower_ra ] = 1;
+            if (cbound[i].upper_ra < 43200)
+                raBreaks[ cbound[i].upper_ra ] = 1;
+            int dec = cbound[i].lower_dec + 5400;
+            if (dec > 0 && dec < 10800)
+                decBreaks[ dec ] = 1;
+        }
+        raBreaks[0] = decBreaks[0] = 0;
+        for (size_t i = 1; i < raBreaks.size(); i++)
+            raBreaks[i] += raBreaks[i - 1];
+        for (size_t i = 1; i < decBreaks.size(); i++)
+            decBreaks[i] += decBreaks[i - 1];
+
+        for (int row = 0; row < RASTER_ROWS; row++) {
+            int dec0 = row * RASTER_DEC;
+            bool decInside = decBreaks[dec0 + RASTER_DEC - 1] != decBreaks[dec0];
+            for (int col = 0; col < RASTER_COLS; col++) {
+                int ra0 = col * RASTER_RA;
+                bool raInside = raBreaks[ra0 + RASTER_RA - 1] != raBreaks[ra0];
+                if (decInside || raInside)
+                    cells[row][col] = RASTER_BOUNDARY;
+                else
+                    cells[row][col] = (signed char)lookupConstellationId( (unsigned short)ra0, (short)(dec0 - 5400) );
+            }
+        }
+    }
+
+    int classify( double _ra, double _dec ) const {
+        // outside the raster (or NaN): same as getConstellationId()
+        if ( !(_ra >= 0.0 && _ra < 360.0 && _dec >= -90.0 && _dec < 90.0) )
+            return getConstellationId(_ra, _dec);
+
+        unsigned short ra = ( unsigned short )( (_ra * MathOps::DEGS_TO_HRS) * 1800 );
+        short de = ( short )( _dec * 60 );
+        if (_dec < 0.0) {
+            --de;
+        }
+
+        int row = de + 5400;
+        if (ra >= 43200 || row < 0 || row >= 10800)
+            return lookupConstellationId( ra, de );
+
+        signed char id = cells[row / RASTER_DEC][ra / RASTER_RA];
+        return (id == RASTER_BOUNDARY) ? lookupConstellationId( ra, de ) : (int)id;
+    }
+};
+
+// matrix taking unit vectors at _epoch to Constellation::EPOCH, computed once per epoch
+hypatia::mat3 getPrecession( double _epoch ) {
+    // callers usually stay on one epoch: each thread keeps the last matrix it got, so
+    // the shared cache (and its lock) is only reached when the epoch changes
+    thread_local bool haveLast = false;
+    thread_local double lastEpoch = 0.0;
+    thread_local hypatia::mat3 lastMatrix;
+    if (haveLast && lastEpoch == _epoch)
+        return lastMatrix;
+
+    static std::mutex mutex;
+    static std::map<double, hypatia::mat3> cache;
+
+    hypatia::mat3 m;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<double, hypatia::mat3>::const_iterator it = cache.find(_epoch);
+        if (it != cache.end())
+            m = it->second;
+        else {
+            if (cache.size() >= MAX_EPOCHS)
+                cache.clear();
+
+            // PrecessionMatrix is always backward, CoordOps::precess() applies it as m * v
+            m = PrecessionMatrix(Constellation::EPOCH, _epoch).getCore();
+            cache[_epoch] = m;
+        }
+    }
+
+    haveLast = true;
+    lastEpoch = _epoch;
+    lastMatrix = m;
+    return m;
+}
+
+// right ascension and declination in degrees at EPOCH of a unit vector
+inline void toDegrees( double _x, double _y, double _z, double& _ra, double& _dec ) {
+    _ra = MathOps::toDegrees( atan2(_y, _x) );
+    if (_ra < 0.0)
+        _ra += 360.0;
+    if (_ra >= 360.0)
+        _ra -= 360.0;
+    _dec = MathOps::toDegrees( asin( MathOps::clamp(_z, -1.0, 1.0) ) );
+}
+
+void classifyRange( const double* _ra, const double* _dec, int* _ids, size_t _begin, size_t _end ) {
+    const Raster& raster = hypatia::getLazy<Raster>();
+    for (size_t i = _begin; i < _end; i++)
+        _ids[i] = raster.classify(_ra[i], _dec[i]);
+}
+
+// positions in degrees at some epoch, precessed by _m block by block before the lookup
+void classifyRange( const hypatia::mat3& _m, const double* _ra, const double* _dec, int* _ids, size_t _begin, size_t _end ) {
+    const Raster& raster = hypatia::getLazy<Raster>();
+    double x[BLOCK], y[BLOCK], z[BLOCK];
+
+    for (size_t first = _begin; first < _end; first += BLOCK) {
+        const size_t n = std::min(BLOCK, _end - first);
+
+        for (size_t i = 0; i < n; i++) {
+            const double ra = MathOps::toRadians(_ra[first + i]);
+            const double dec = MathOps::toRadians(_dec[first + i]);
+            const double cosDec = cos(dec);
+            x[i] = cos(ra) * cosDec;
+            y[i] = sin(ra) * cosDec;
+            z[i] = sin(dec);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            const double px = _m.m[0][0] * x[i] + _m.m[0][1] * y[i] + _m.m[0][2] * z[i];
+            const double py = _m.m[1][0] * x[i] + _m.m[1][1] * y[i] + _m.m[1][2] * z[i];
+            const double pz = _m.m[2][0] * x[i] + _m.m[2][1] * y[i] + _m.m[2][2] * z[i];
+            x[i] = px;
+            y[i] = py;
+            z[i] = pz;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            double ra, dec;
+            toDegrees(x[i], y[i], z[i], ra, dec);
+            _ids[first + i] = raster.classify(ra, dec);
+        }
+    }
+}
+
+}
+
 Constellation::Constellation() : m_id(-1) {
 }
 
@@ -919,13 +1103,124 @@ Constellation::Constellation( int _id ) : m_id(-1) {
 };
 
 Constellation::Constellation( double _ra, double _dec ) : m_id(-1) {
-    setId( getConstellationId(_ra, _dec) );
+    setId( classify(_ra, _dec) );
 }
 
 Constellation::Constellation( const Equatorial &_point ) : m_id(-1) {
     double ra = _point.getRightAscension(DEGS);
     double dec = _point.getDeclination(DEGS);
-    setId( getConstellationId( ra, dec ) );
+    setId( classify( ra, dec ) );
+}
+
+Constellation::Constellation( const Equatorial &_point, double _epoch ) : m_id(-1) {
+    setId( classifyAtEpoch( _point, _epoch ) );
+}
+
+/**
+ * lookup() - constellation of a position (equinox 1875) by the search of
+ *            getConstellationId(), without the raster. The reference classify()
+ *            is checked against
+ *
+ * @param _ra - right ascension (degrees)
+ * @param _dec - declination (degrees)
+ *
+ * @return constellation id, -1 if there is none
+ */
+int Constellation::lookup( double _ra, double _dec ) {
+    return getConstellationId( _ra, _dec );
+}
+
+/**
+ * classify() - constellation of a position (equinox 1875)
+ *
+ * Same as the search of getConstellationId(), answered from the lookup raster
+ * with a single read except within a quarter of a degree of a boundary.
+ *
+ * @param _ra - right ascension (degrees)
+ * @param _dec - declination (degrees)
+ *
+ * @return constellation id, -1 if there is none
+ */
+int Constellation::classify( double _ra, double _dec ) {
+    return hypatia::getLazy<Raster>().classify(_ra, _dec);
+}
+
+/**
+ * classify() - constellation of many positions (equinox 1875)
+ *
+ * @param _ra - right ascensions (degrees)
+ * @param _dec - declinations (degrees)
+ * @param _count - number of positions
+ * @param _ids - output, _count constellation ids
+ * @param _threads - worker threads, 0 for one per hardware thread
+ */
+void Constellation::classify( const double* _ra, const double* _dec, size_t _count, int* _ids, unsigned _threads ) {
+    // build the raster before the workers race for it
+    hypatia::getLazy<Raster>();
+
+    hypatia::forEachRange(_count, _threads, MIN_PER_THREAD, [=](size_t _begin, size_t _end) {
+        classifyRange(_ra, _dec, _ids, _begin, _end);
+    });
+}
+
+std::vector<int> Constellation::classify( const std::vector<double>& _ra, const std::vector<double>& _dec, unsigned _threads ) {
+    std::vector<int> ids( std::min(_ra.size(), _dec.size()) );
+    classify(_ra.data(), _dec.data(), ids.size(), ids.data(), _threads);
+    return ids;
+}
+
+/**
+ * classifyAtEpoch() - constellation of a position at any epoch
+ *
+ * The position is precessed to EPOCH, the equinox of the boundaries, with a
+ * matrix computed once per epoch and cached.
+ *
+ * @param _point - equatorial position at _epoch
+ * @param _epoch - epoch of _point (years, 2000.0 for J2000)
+ *
+ * @return constellation id, -1 if there is none
+ */
+int Constellation::classifyAtEpoch( const Equatorial& _point, double _epoch ) {
+    if (_epoch == EPOCH)
+        return classify( _point.getRightAscension(DEGS), _point.getDeclination(DEGS) );
+
+    const hypatia::vec3 v = getPrecession(_epoch) * hypatia::toVector(_point.getCore());
+    double ra, dec;
+    toDegrees(v.x, v.y, v.z, ra, dec);
+    return hypatia::getLazy<Raster>().classify(ra, dec);
+}
+
+/**
+ * classifyAtEpoch() - constellation of many positions at any epoch
+ *
+ * Positions are precessed to EPOCH in blocks, with the 3x3 product running
+ * over arrays of vectors.
+ *
+ * @param _ra - right ascensions at _epoch (degrees)
+ * @param _dec - declinations at _epoch (degrees)
+ * @param _count - number of positions
+ * @param _epoch - epoch of the positions (years, 2000.0 for J2000)
+ * @param _ids - output, _count constellation ids
+ * @param _threads - worker threads, 0 for one per hardware thread
+ */
+void Constellation::classifyAtEpoch( const double* _ra, const double* _dec, size_t _count, double _epoch, int* _ids, unsigned _threads ) {
+    if (_epoch == EPOCH) {
+        classify(_ra, _dec, _count, _ids, _threads);
+        return;
+    }
+
+    const hypatia::mat3 m = getPrecession(_epoch);
+    hypatia::getLazy<Raster>();
+
+    hypatia::forEachRange(_count, _threads, MIN_PER_THREAD, [=, &m](size_t _begin, size_t _end) {
+        classifyRange(m, _ra, _dec, _ids, _begin, _end);
+    });
+}
+
+std::vector<int> Constellation::classifyAtEpoch( const std::vector<double>& _ra, const std::vector<double>& _dec, double _epoch, unsigned _threads ) {
+    std::vector<int> ids( std::min(_ra.size(), _dec.size()) );
+    classifyAtEpoch(_ra.data(), _dec.data(), ids.size(), _epoch, ids.data(), _threads);
+    return ids;
 }
 
 Constellation::Constellation( char * _abbr ) : m_id(-1) {
@@ -943,17 +1238,89 @@ void Constellation::setId( int _id ) {
     }
 
     m_id = _id;
-    m_centroid = Equatorial(cns_centroid[_id][0], cns_centroid[_id][1], DEGS);
+}
 
-    m_sIndices.clear();
-    for (int i = 1; i <= cns_stars[_id][0]; i++) {
-        m_sIndices.push_back(cns_stars[_id][i]);
+namespace {
+
+// cns_boundaries[] without the counts and in radians
+struct BoundaryTable {
+    double radians[N_CONSTELATIONS][103];
+
+    BoundaryTable() {
+        for (int id = 0; id < N_CONSTELATIONS; id++)
+            for (int i = 1; i <= (int)cns_boundaries[id][0]; i++)
+                radians[id][i - 1] = MathOps::toRadians(cns_boundaries[id][i]);
+    }
+};
+
+}
+
+Equatorial Constellation::getEquatorialCentroid() const {
+    if ( m_id < 0 ) {
+        return Equatorial();
+    }
+    return Equatorial(cns_centroid[m_id][0], cns_centroid[m_id][1], DEGS);
+}
+
+/**
+ * getStarIndicesData() - star indices of the figure, straight from the static table
+ *
+ * Consecutive pairs are the ends of the figure's lines. The pointer stays
+ * valid for the life of the program.
+ *
+ * @return getTotalStarIndices() star indices, NULL if there is no constellation
+ */
+const int* Constellation::getStarIndicesData() const {
+    if ( m_id < 0 ) {
+        return NULL;
+    }
+    return &cns_stars[m_id][1];
+}
+
+int Constellation::getTotalStarIndices() const {
+    if ( m_id < 0 ) {
+        return 0;
+    }
+    return cns_stars[m_id][0];
+}
+
+/**
+ * getBoundaryData() - boundary vertices, straight from a static table
+ *
+ * The table is converted to radians once, on first use. The pointer stays
+ * valid for the life of the program.
+ *
+ * @return getTotalBoundaryPoints() pairs of right ascension and declination (radians)
+ *         at equinox 1875, NULL if there is no constellation
+ */
+const double* Constellation::getBoundaryData() const {
+    if ( m_id < 0 ) {
+        return NULL;
     }
-    
-    m_boundary.clear();
-    for (int i = 1; i <= cns_boundaries[_id][0]; i+=2) {
-        m_boundary.push_back(Equatorial(cns_boundaries[_id][i], cns_boundaries[_id][i+1], DEGS));
+    return hypatia::getLazy<BoundaryTable>().radians[m_id];
+}
+
+int Constellation::getTotalBoundaryPoints() const {
+    if ( m_id < 0 ) {
+        return 0;
+    }
+    return (int)cns_boundaries[m_id][0] / 2;
+}
+
+std::vector<int> Constellation::getStarIndices() const {
+    const int* data = getStarIndicesData();
+    return std::vector<int>(data, data + getTotalStarIndices());
+}
+
+std::vector<Equatorial> Constellation::getBoundary() const {
+    std::vector<Equatorial> boundary;
+    const double* data = getBoundaryData();
+    int total = getTotalBoundaryPoints();
+    boundary.reserve(total);
+    for (int i = 0; i < total; i++) {
+        boundary.push_back(Equatorial(data[i * 2], data[i * 2 + 1], RADS));
     }
+    return boundary;
 }
 
 /* given a constellation id (as from cns_pick()), return pointer to static
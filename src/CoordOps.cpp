@@ -51,17 +51,37 @@ const double CoordOps::SUN_DIAMETER_KM = 1392000;
  */
 Ecliptic CoordOps::toHeliocentric(Observer& _obs, const Ecliptic& _geocentric ){
     
-    // Compute Sun's coords
-    double sun_eclipticLon, sun_eclipticLat, sun_radius;
-    VSOP87::calcAllLocs( sun_eclipticLon, sun_eclipticLat, sun_radius, _obs.getJC(), EARTH);
+    // Earth's position is cached by the observer until its JD changes
+    hypatia::vec3 Sun2Earth = _obs.getHeliocentricVector(AU).getCore();
+    hypatia::vec3 Earth2Moon = hypatia::toVector(_geocentric.getCore());
     
-    // Get HelioCentric values
-    Ecliptic toEarth = Ecliptic(sun_eclipticLon, sun_eclipticLat, sun_radius, RADS, AU);
-    Vector3 Sun2Earth = toEarth.getVector(AU);
-    Vector3 Earth2Moon = _geocentric.getVector(AU);
-    Vector3 Sun2Moon = Sun2Earth + Earth2Moon;
-    
-    return Ecliptic(Sun2Moon, AU);
+    return Ecliptic( hypatia::toEcliptic(Sun2Earth + Earth2Moon) );
+}
+
+/**
+ * toHeliocentric() - ecliptic transformation from geocentric to heliocentric
+ *
+ * @param EpochContext
+ * @param Ecliptic geocentric
+ *
+ * @return Ecliptic heliocentric
+ */
+Ecliptic CoordOps::toHeliocentric(const EpochContext& _epoch, const Ecliptic& _geocentric ){
+    hypatia::vec3 heliocentric = _epoch.getEarthHeliocentricVector(AU).getCore() + hypatia::toVector(_geocentric.getCore());
+    return Ecliptic( hypatia::toEcliptic(heliocentric) );
+}
+
+/**
+ * toHeliocentric() - ecliptic transformation from geocentric to heliocentric
+ *
+ * @param ObserverState
+ * @param Ecliptic geocentric
+ *
+ * @return Ecliptic heliocentric
+ */
+Ecliptic CoordOps::toHeliocentric(const ObserverState& _state, const Ecliptic& _geocentric ){
+    hypatia::vec3 heliocentric = _state.getHeliocentricVector(AU).getCore() + hypatia::toVector(_geocentric.getCore());
+    return Ecliptic( hypatia::toEcliptic(heliocentric) );
 }
 
 //---------------------------------------------------------------------------- to Geocentric
@@ -75,8 +95,34 @@ Ecliptic CoordOps::toHeliocentric(Observer& _obs, const Ecliptic& _geocentric ){
  * @return Ecliptic geocentric
  */
 Ecliptic CoordOps::toGeocentric( Observer& _obs, const Ecliptic& _heliocentric ) {
-    Vector3 heliocentric = _heliocentric.getVector(AU);
-    return Ecliptic(heliocentric - _obs.getHeliocentricVector(AU), AU);
+    hypatia::vec3 heliocentric = hypatia::toVector(_heliocentric.getCore());
+    return Ecliptic( hypatia::toEcliptic(heliocentric - _obs.getHeliocentricVector(AU).getCore()) );
+}
+
+/**
+ * toGeocentric() - ecliptic transformation from heliocentric to geocentric
+ *
+ * @param EpochContext
+ * @param Ecliptic heliocentric
+ *
+ * @return Ecliptic geocentric
+ */
+Ecliptic CoordOps::toGeocentric( const EpochContext& _epoch, const Ecliptic& _heliocentric ) {
+    hypatia::vec3 heliocentric = hypatia::toVector(_heliocentric.getCore());
+    return Ecliptic( hypatia::toEcliptic(heliocentric - _epoch.getEarthHeliocentricVector(AU).getCore()) );
+}
+
+/**
+ * toGeocentric() - ecliptic transformation from heliocentric to geocentric
+ *
+ * @param ObserverState
+ * @param Ecliptic heliocentric
+ *
+ * @return Ecliptic geocentric
+ */
+Ecliptic CoordOps::toGeocentric( const ObserverState& _state, const Ecliptic& _heliocentric ) {
+    hypatia::vec3 heliocentric = hypatia::toVector(_heliocentric.getCore());
+    return Ecliptic( hypatia::toEcliptic(heliocentric - _state.getHeliocentricVector(AU).getCore()) );
 }
 
 /**
@@ -121,6 +167,54 @@ Ecliptic CoordOps::toGeocentric (Observer& _obs, const ECI& _eci) {
     return toGeocentric(_obs.getObliquity(), equat.getRightAscension(RADS), equat.getDeclination(RADS) , distance);
 }
 
+Ecliptic CoordOps::toGeocentric (const ObserverState& _state, const ECI& _eci) {
+    double distance = _eci.getPosition(AU).getMagnitud();
+    Equatorial equat = Equatorial(_eci.getPosition(AU));
+    return toGeocentric(_state.getObliquity(), equat.getRightAscension(RADS), equat.getDeclination(RADS) , distance);
+}
+
+//---------------------------------------------------------------------------- Ecliptic velocity
+
+/**
+ * toEclipticVelocity() - rates of ecliptic longitude, latitude and radius
+ *                        to a rectangular ecliptic velocity
+ *
+ * Derivative of ( r cos(b) cos(l), r cos(b) sin(l), r sin(b) ).
+ *
+ * @param Ecliptic position
+ * @param longitude rate (radians per day)
+ * @param latitude rate (radians per day)
+ * @param radius rate (AU per day)
+ *
+ * @return velocity (AU per day)
+ */
+Vector3 CoordOps::toEclipticVelocity (const Ecliptic& _position, double _dLng, double _dLat, double _dRad) {
+    double r = _position.getRadius(AU);
+    double sl = sin(_position.getLongitude(RADS));
+    double cl = cos(_position.getLongitude(RADS));
+    double sb = sin(_position.getLatitude(RADS));
+    double cb = cos(_position.getLatitude(RADS));
+
+    return Vector3( _dRad * cb * cl - r * sb * cl * _dLat - r * cb * sl * _dLng,
+                    _dRad * cb * sl - r * sb * sl * _dLat + r * cb * cl * _dLng,
+                    _dRad * sb + r * cb * _dLat );
+}
+
+/**
+ * toLongitudeRate() - rate of ecliptic longitude of a rectangular position and velocity
+ *
+ * @param position (AU)
+ * @param velocity (AU per day)
+ *
+ * @return longitude rate (radians per day), negative when retrograde
+ */
+double CoordOps::toLongitudeRate (const Vector3& _position, const Vector3& _velocity) {
+    double d = _position.x * _position.x + _position.y * _position.y;
+    if (d == 0.0)
+        return 0.0;
+    return (_position.x * _velocity.y - _position.y * _velocity.x) / d;
+}
+
 //---------------------------------------------------------------------------- to Earth Center Innertial
 
 /**
@@ -256,6 +350,36 @@ Equatorial CoordOps::toEquatorial ( const Observer& _obs, const Ecliptic &_eclip
     return toEquatorial(_obs.getObliquity(), lng, lat);
 }
 
+/**
+ * toEquatorial() - ecliptic to equatorial coordinates
+ *                          (Meeus, Ch. 93)
+ *
+ * @param EpochContext
+ * @param Ecliptic position
+ *
+ * @return Equatorial position
+ */
+Equatorial CoordOps::toEquatorial ( const EpochContext& _epoch, const Ecliptic &_ecliptic ) {
+    double lng = _ecliptic.getLongitude(RADS);
+    double lat = _ecliptic.getLatitude(RADS);
+    return toEquatorial(_epoch.getObliquity(), lng, lat);
+}
+
+/**
+ * toEquatorial() - ecliptic to equatorial coordinates
+ *                          (Meeus, Ch. 93)
+ *
+ * @param ObserverState
+ * @param Ecliptic position
+ *
+ * @return Equatorial position
+ */
+Equatorial CoordOps::toEquatorial ( const ObserverState& _state, const Ecliptic &_ecliptic ) {
+    double lng = _ecliptic.getLongitude(RADS);
+    double lat = _ecliptic.getLatitude(RADS);
+    return toEquatorial(_state.getObliquity(), lng, lat);
+}
+
 //---------------------------------------------------------------------------- to Hour Angle
 /**
  * toHourAngle() - calcuate hour angle
@@ -283,6 +407,10 @@ double CoordOps::toHourAngle( const Observer& _obs, double _ra ) {
     return _obs.getLST() - _ra;
 }
 
+double CoordOps::toHourAngle( const ObserverState& _state, double _ra ) {
+    return _state.getLST() - _ra;
+}
+
 /**
  * toHourAngle() - calcuate hour angle
  *                          (Meeus, Ch. 92)
@@ -296,6 +424,10 @@ double CoordOps::toHourAngle( const Observer& _obs, const Equatorial &_equatoria
     return _obs.getLST() - _equatorial.getRightAscension(RADS);
 }
 
+double CoordOps::toHourAngle( const ObserverState& _state, const Equatorial &_equatorial ) {
+    return _state.getLST() - _equatorial.getRightAscension(RADS);
+}
+
 //---------------------------------------------------------------------------- to Geodetic
 
 /**
@@ -362,7 +494,8 @@ Horizontal CoordOps::toHorizontal ( double _lat, double _ha, double _dec) {
     
     // compute azimuth in radians
     // divide by zero error at poles or if alt = 90 deg (so we should've already limited to 89.9999)
-    double az = acos((sd - sin(alt)*sl)/(cos(alt)*cl));
+    // on the meridian rounding can push the cosine slightly past 1
+    double az = acos( MathOps::clamp((sd - sin(alt)*sl)/(cos(alt)*cl), -1.0, 1.0) );
     
     // choose hemisphere
     if (sin(_ha) > 0.0)
@@ -386,6 +519,12 @@ Horizontal CoordOps::toHorizontal( const Observer& _obs, const Equatorial& _equa
     return toHorizontal(_obs.getLocation().getLatitude(RADS), ha, dec);
 }
 
+Horizontal CoordOps::toHorizontal( const ObserverState& _state, const Equatorial& _equatorial) {
+    double dec = _equatorial.getDeclination(RADS);
+    double ha = toHourAngle(_state, _equatorial);
+    return toHorizontal(_state.getLocation().getLatitude(RADS), ha, dec);
+}
+
 /**
  * toEquatorial() - Eart Centered Innertial to horizontal coordinates
  *                          (Meeus, Ch. 93)
@@ -396,7 +535,23 @@ Horizontal CoordOps::toHorizontal( const Observer& _obs, const Equatorial& _equa
  * @return horizontal position
  */
 Horizontal CoordOps::toHorizontal(const Observer& _obs, const ECI& _eci) {
-    ECI obs = ECI(_eci.getJD(), _obs.getLocation());
+    return toHorizontal(_obs.getLocation(), _eci);
+}
+
+Horizontal CoordOps::toHorizontal(const ObserverState& _state, const ECI& _eci) {
+    return toHorizontal(_state.getLocation(), _eci);
+}
+
+/**
+ * toHorizontal() - Eart Centered Innertial to horizontal coordinates
+ *
+ * @param geodetic location of the observer
+ * @param Earth Center Innertial
+ *
+ * @return horizontal position
+ */
+Horizontal CoordOps::toHorizontal(const Geodetic& _location, const ECI& _eci) {
+    ECI obs = ECI(_eci.getJD(), _location);
     
     /*
      * calculate differences
@@ -407,10 +562,10 @@ Horizontal CoordOps::toHorizontal(const Observer& _obs, const ECI& _eci) {
     /*
      * Calculate Local Mean Sidereal Time for observers longitude
      */
-    double theta = TimeOps::toLocalSideralTime(_eci.getJD(), _obs.getLocation().getLongitude(RADS), RADS);
+    double theta = TimeOps::toLocalSideralTime(_eci.getJD(), _location.getLongitude(RADS), RADS);
     
-    double sin_lat = sin(_obs.getLocation().getLatitude(RADS));
-    double cos_lat = cos(_obs.getLocation().getLatitude(RADS));
+    double sin_lat = sin(_location.getLatitude(RADS));
+    double cos_lat = cos(_location.getLatitude(RADS));
     double sin_theta = sin(theta);
     double cos_theta = cos(theta);
     
@@ -887,15 +1042,16 @@ Equatorial CoordOps::precess(const PrecessionMatrix& _matrix, const Equatorial&
     
     const double old_ra = _equatorial.getRightAscension(RADS);
     
-    Vector3 v1 = _equatorial.getVector();
+    hypatia::vec3 v1 = hypatia::toVector(_equatorial.getCore());
+    hypatia::mat3 m = _matrix.getCore();
     
     double ra, dec;
     
-    Vector3 v2;
+    hypatia::vec3 v2;
     if( _matrix.isBackward())
-        v2 = _matrix.deprecess(v1);
+        v2 = m * v1;
     else
-        v2 = _matrix.precess(v1);
+        v2 = hypatia::mulTransposed(m, v1);
 
     if (v2.y != 0.0 || v2.x != 0.0)
         ra = atan2( v2.y, v2.x);
@@ -0,0 +1,96 @@
+/*****************************************************************************\
+ * EpochContext.cpp
+ *
+ * Everything that depends only on the julian day, computed once and shared
+ * (read only) by every Observer, Body, Star and Satellite at that epoch.
+ *
+\*****************************************************************************/
+
+#include "hypatia/EpochContext.h"
+
+#include "hypatia/CoordOps.h"
+#include "hypatia/TimeOps.h"
+
+#include "hypatia/models/VSOP87.h"
+
+EpochContext::EpochContext() : m_jd(0.0), m_jcentury(0.0), m_obliquity(0.0), m_nutationLng(0.0), m_nutationObl(0.0), m_gmst(0.0) {
+    for (int i = 0; i < 6; i++)
+        m_tPowers[i] = 0.0;
+}
+
+/**
+ * EpochContext() - evaluate the epoch dependent quantities of a julian day
+ *
+ *   - Earth's heliocentric position and velocity (VSOP87, the most expensive part)
+ *   - the mean obliquity of the ecliptic and the ecliptic to equatorial rotation
+ *   - the nutation in longitude and obliquity
+ *   - the Greenwich mean sidereal time
+ *
+ * Each one matches, bit for bit, what Observer and Body compute on their own.
+ *
+ * @param _jd - julian day
+ */
+EpochContext::EpochContext( double _jd ) : m_jd(_jd) {
+    m_jcentury = TimeOps::toJC(_jd);
+    m_obliquity = CoordOps::meanObliquity(m_jcentury);
+    m_eclipticToEquatorial = CoordOps::eclipticToEquatorial(m_obliquity);
+    CoordOps::nutation(_jd, &m_nutationLng, &m_nutationObl);
+    m_gmst = TimeOps::toGreenwichSiderealTime(_jd);
+
+    VSOP87::toPowers(m_jcentury, m_tPowers);
+
+    double lng, lat, rad;
+    double dLng, dLat, dRad;
+    VSOP87::calcAllLocsAndRates(lng, lat, rad, dLng, dLat, dRad, m_jcentury, EARTH);
+    m_earth = Ecliptic(lng, lat, rad, RADS, AU);
+    m_earthVector = m_earth.getVector(AU);
+    m_earthVelocity = CoordOps::toEclipticVelocity(m_earth, dLng, dLat, dRad);
+}
+
+EpochContext::~EpochContext() {
+}
+
+double EpochContext::getNutationLongitude( ANGLE_UNIT _type ) const {
+    if ( _type == DEGS ) {
+        return m_nutationLng / MathOps::SECONDS_PER_DEGREE;
+    }
+    else {
+        return MathOps::secToRadians( m_nutationLng );
+    }
+}
+
+double EpochContext::getNutationObliquity( ANGLE_UNIT _type ) const {
+    if ( _type == DEGS ) {
+        return m_nutationObl / MathOps::SECONDS_PER_DEGREE;
+    }
+    else {
+        return MathOps::secToRadians( m_nutationObl );
+    }
+}
+
+double EpochContext::getGMST( ANGLE_UNIT _type ) const {
+    if ( _type == DEGS ) {
+        return MathOps::toDegrees( m_gmst );
+    }
+    else {
+        return m_gmst;
+    }
+}
+
+Vector3 EpochContext::getEarthHeliocentricVector( DISTANCE_UNIT _type ) const {
+    if ( _type == AU ) {
+        return m_earthVector;
+    }
+    else {
+        return m_earth.getVector(_type);
+    }
+}
+
+Vector3 EpochContext::getEarthHeliocentricVelocity( DISTANCE_UNIT _type ) const {
+    if ( _type == AU ) {
+        return m_earthVelocity;
+    }
+    else {
+        return Ecliptic(m_earthVelocity, AU).getVector(_type);
+    }
+}
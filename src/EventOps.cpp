@@ -0,0 +1,276 @@
+/*****************************************************************************\
+ * EventOps.cpp
+ *
+ * Rise, transit and set times of bodies and stars.
+ *
+\*****************************************************************************/
+
+#include "hypatia/EventOps.h"
+
+#include "hypatia/Luna.h"
+#include "hypatia/Satellite.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <math.h>
+
+const double EventOps::HORIZON_STAR = -0.5667;
+const double EventOps::HORIZON_SUN = -0.8333;
+const double EventOps::HORIZON_LUNA = 0.125;
+const double EventOps::CIVIL_TWILIGHT = -6.0;
+const double EventOps::NAUTICAL_TWILIGHT = -12.0;
+const double EventOps::ASTRONOMICAL_TWILIGHT = -18.0;
+
+// refinement stops when the bracket is narrower than this (days, ~0.1 sec)
+static const double TOLERANCE = 1e-6;
+static const int    MAX_ITERATIONS = 60;
+
+namespace {
+
+// Evaluates an object for an observer at any julian day, on private copies of both
+template<class T>
+class Tracker {
+public:
+    Tracker( const T& _object, const Observer& _obs, double _horizon ) : m_object(_object), m_obs(_obs), m_horizon(_horizon) {}
+
+    // altitude above the horizon and hour angle in (-PI, PI], both in radians
+    void at( double _jd, double& _alt, double& _ha ) {
+        m_obs.setJD(_jd);
+        m_object.compute(m_obs);
+        _alt = m_object.getHorizontal().getAltitud(RADS) - m_horizon;
+        _ha = m_object.getHourAngle(RADS);
+        if (_ha > MathOps::PI)
+            _ha -= MathOps::TAU;
+    }
+
+    Event event( double _jd, EVENT_TYPE _type ) {
+        m_obs.setJD(_jd);
+        m_object.compute(m_obs);
+
+        Event e;
+        e.jd = _jd;
+        e.type = _type;
+        e.alt = m_object.getHorizontal().getAltitud(RADS);
+        e.az = m_object.getHorizontal().getAzimuth(RADS);
+        return e;
+    }
+
+private:
+    T           m_object;
+    Observer    m_obs;
+    double      m_horizon;
+};
+
+enum Quantity { ALTITUDE, HOUR_ANGLE, HOUR_ANGLE_LOWER };
+
+template<class T>
+double evaluate( Tracker<T>& _tracker, double _jd, Quantity _quantity ) {
+    double alt, ha;
+    _tracker.at(_jd, alt, ha);
+    if (_quantity == ALTITUDE)
+        return alt;
+    if (_quantity == HOUR_ANGLE)
+        return ha;
+
+    // continuous around the lower transit ( ha = PI )
+    return (ha < 0.0) ? ha + MathOps::PI : ha - MathOps::PI;
+}
+
+// root of a quantity between _a and _b, where it changes sign (Illinois variant of regula falsi)
+template<class T>
+double refine( Tracker<T>& _tracker, Quantity _quantity, double _a, double _fa, double _b, double _fb ) {
+    int side = 0;
+    double c = _a;
+    for (int i = 0; i < MAX_ITERATIONS && (_b - _a) > TOLERANCE; i++) {
+        c = (_a * _fb - _b * _fa) / (_fb - _fa);
+        double fc = evaluate(_tracker, c, _quantity);
+
+        if (fc == 0.0)
+            return c;
+
+        if ((fc > 0.0) == (_fb > 0.0)) {
+            _b = c; _fb = fc;
+            if (side == -1)
+                _fa *= 0.5;
+            side = -1;
+        }
+        else {
+            _a = c; _fa = fc;
+            if (side == 1)
+                _fb *= 0.5;
+            side = 1;
+        }
+    }
+    return (_a + _b) * 0.5;
+}
+
+template<class T>
+std::vector<Event> solve( Tracker<T>& _tracker, double _jd0, double _jd1, double _step ) {
+    std::vector<Event> events;
+    if (_jd1 < _jd0 || _step <= 0.0)
+        return events;
+
+    double a = _jd0;
+    double altA, haA;
+    _tracker.at(a, altA, haA);
+
+    while (a < _jd1) {
+        double b = std::min(a + _step, _jd1);
+        double altB, haB;
+        _tracker.at(b, altB, haB);
+
+        // split the interval at the culminations, where the altitude turns around,
+        // so each piece holds at most one horizon crossing
+        double cut[4] = { a, 0.0, 0.0, b };
+        double cutAlt[4] = { altA, 0.0, 0.0, altB };
+        int cuts = 1;
+
+        if (haA < 0.0 && haB >= 0.0 && (haB - haA) < MathOps::PI) {
+            double t = refine(_tracker, HOUR_ANGLE, a, haA, b, haB);
+            events.push_back( _tracker.event(t, TRANSIT) );
+            cut[cuts] = t;
+            cutAlt[cuts] = evaluate(_tracker, t, ALTITUDE);
+            cuts++;
+        }
+        else if (haA > 0.0 && haB < 0.0 && (haA - haB) > MathOps::PI) {
+            double lowA = haA - MathOps::PI;
+            double lowB = haB + MathOps::PI;
+            double t = refine(_tracker, HOUR_ANGLE_LOWER, a, lowA, b, lowB);
+            cut[cuts] = t;
+            cutAlt[cuts] = evaluate(_tracker, t, ALTITUDE);
+            cuts++;
+        }
+        cut[cuts] = b;
+        cutAlt[cuts] = altB;
+
+        for (int i = 0; i < cuts; i++) {
+            if ((cutAlt[i] < 0.0) != (cutAlt[i + 1] < 0.0)) {
+                double t = refine(_tracker, ALTITUDE, cut[i], cutAlt[i], cut[i + 1], cutAlt[i + 1]);
+                events.push_back( _tracker.event(t, (cutAlt[i] < 0.0) ? RISE : SET) );
+            }
+        }
+
+        a = b;
+        altA = altB;
+        haA = haB;
+    }
+
+    std::sort(events.begin(), events.end(), [](const Event& _a, const Event& _b) { return _a.jd < _b.jd; });
+    return events;
+}
+
+template<class T>
+std::vector<Event> track( const T& _object, const Observer& _obs, double _jd0, double _jd1, double _horizon_deg, double _step ) {
+    Tracker<T> tracker(_object, _obs, MathOps::toRadians(_horizon_deg));
+    return solve(tracker, _jd0, _jd1, _step);
+}
+
+std::vector<Event> trackBody( const Body& _body, const Observer& _obs, double _jd0, double _jd1, double _horizon_deg, double _step ) {
+    // keep the derived compute() of Luna and Satellite
+    if (const Luna* luna = dynamic_cast<const Luna*>(&_body))
+        return track(*luna, _obs, _jd0, _jd1, _horizon_deg, _step);
+    if (const Satellite* satellite = dynamic_cast<const Satellite*>(&_body))
+        return track(*satellite, _obs, _jd0, _jd1, _horizon_deg, _step);
+    return track(_body, _obs, _jd0, _jd1, _horizon_deg, _step);
+}
+
+}
+
+/**
+ * getHorizon() - standard altitude of the horizon for rise and set
+ *
+ * @param _id - body
+ *
+ * @return altitude in degrees
+ */
+double EventOps::getHorizon( BodyId _id ) {
+    if (_id == SUN)
+        return HORIZON_SUN;
+    if (_id == LUNA)
+        return HORIZON_LUNA;
+    return HORIZON_STAR;
+}
+
+/**
+ * getDefaultStep() - bracketing grid for a body, fine enough for its apparent motion
+ *
+ * @param _id - body
+ *
+ * @return step in days
+ */
+double EventOps::getDefaultStep( BodyId _id ) {
+    if (_id == SATELLITE)
+        return 1.0 / 1440.0;
+    if (_id == LUNA)
+        return 1.0 / 48.0;
+    return 1.0 / 24.0;
+}
+
+/**
+ * findEvents() - rise, transit and set of a body
+ *
+ * Transits are found where the hour angle crosses zero. The grid intervals
+ * are split at the upper and lower culminations before looking for horizon
+ * crossings, so an object that barely rises (or sets) between two grid points
+ * is not missed.
+ *
+ * @param _body - Body, Luna or Satellite
+ * @param _obs - Observer with a location
+ * @param _jd0 - first julian day
+ * @param _jd1 - last julian day
+ * @param _horizon_deg - altitude of the horizon (degrees), see getHorizon() and the twilight constants
+ * @param _step - grid step (days), 0.0 for getDefaultStep()
+ *
+ * @return events sorted by time
+ */
+std::vector<Event> EventOps::findEvents( const Body& _body, const Observer& _obs, double _jd0, double _jd1, double _horizon_deg, double _step ) {
+    if (!_obs.haveLocation())
+        return std::vector<Event>();
+
+    if (_step <= 0.0)
+        _step = getDefaultStep(_body.getId());
+
+    return trackBody(_body, _obs, _jd0, _jd1, _horizon_deg, _step);
+}
+
+std::vector<Event> EventOps::findEvents( const Star& _star, const Observer& _obs, double _jd0, double _jd1, double _horizon_deg, double _step ) {
+    if (!_obs.haveLocation())
+        return std::vector<Event>();
+
+    if (_step <= 0.0)
+        _step = getDefaultStep(NAB);
+
+    return track(_star, _obs, _jd0, _jd1, _horizon_deg, _step);
+}
+
+/**
+ * findEvents() - rise, transit and set of a body for many observers
+ *
+ * @param _body - Body, Luna or Satellite
+ * @param _observers - observers with a location
+ * @param _jd0 - first julian day
+ * @param _jd1 - last julian day
+ * @param _horizon_deg - altitude of the horizon (degrees)
+ * @param _step - grid step (days), 0.0 for getDefaultStep()
+ * @param _threads - worker threads, 0 for one per hardware thread
+ *
+ * @return events of each observer, in the same order as _observers
+ */
+std::vector< std::vector<Event> > EventOps::findEvents( const Body& _body, const std::vector<Observer>& _observers, double _jd0, double _jd1, double _horizon_deg, double _step, unsigned _threads ) {
+    std::vector< std::vector<Event> > events(_observers.size());
+    hypatia::forEachRange(_observers.size(), _threads, 1, [&](size_t _begin, size_t _end) {
+        for (size_t i = _begin; i < _end; i++)
+            events[i] = findEvents(_body, _observers[i], _jd0, _jd1, _horizon_deg, _step);
+    });
+    return events;
+}
+
+std::vector< std::vector<Event> > EventOps::findEvents( const Star& _star, const std::vector<Observer>& _observers, double _jd0, double _jd1, double _horizon_deg, double _step, unsigned _threads ) {
+    std::vector< std::vector<Event> > events(_observers.size());
+    hypatia::forEachRange(_observers.size(), _threads, 1, [&](size_t _begin, size_t _end) {
+        for (size_t i = _begin; i < _end; i++)
+            events[i] = findEvents(_star, _observers[i], _jd0, _jd1, _horizon_deg, _step);
+    });
+    return events;
+}
@@ -2,9 +2,12 @@
 #include "hypatia/MathOps.h"
 #include "hypatia/TimeOps.h"
 
+#include "Lazy.h"
+#include "SphereGrid.h"
 
 #include <math.h>
 #include <cstring>
+#include <algorithm>
 
 const double GeoOps::EARTH_FLATTENING = 1.0 / 298.26;
 const double GeoOps::EARTH_POLAR_RADIUS_KM = 6356.76;
@@ -175,16 +178,73 @@ double GeoOps::distance(const Geodetic& _g1, const Geodetic& _g2) {
     return distance(_g1.getLongitude(DEGS), _g1.getLatitude(DEGS), _g2.getLongitude(DEGS), _g2.getLatitude(DEGS));
 }
 
+// cities further than this are not the closest city of a location (km)
+static const double CITY_MAX_DISTANCE = 50.0;
+
+// side of the cells of the city grid (degrees)
+static const double CITY_CELL_DEGS = 1.0;
+
+namespace {
+
+// City indices by latitude / longitude cell. Index 0 ("unknown") is left out
+struct CityGrid : hypatia::SphereGrid {
+    CityGrid() : SphereGrid(CITY_CELL_DEGS, false) {
+        std::vector<int> cellOfCity(CITIES_N, -1);
+        for (int i = 1; i < CITIES_N; i++)
+            cellOfCity[i] = getCell(MathOps::toRadians(cities_loc[i][1]), MathOps::toRadians(cities_loc[i][0]));
+        fill(cellOfCity);
+    }
+};
+
+struct CityDistance {
+    double  dist;
+    size_t  index;
+
+    bool operator<( const CityDistance& _other ) const {
+        return (dist != _other.dist) ? dist < _other.dist : index < _other.index;
+    }
+};
+
+// cities within _radius_km of the location, closest first (ties by index)
+std::vector<CityDistance> citiesWithin( double _lng, double _lat, double _radius_km ) {
+    std::vector<CityDistance> found;
+    if (!(_radius_km >= 0.0))
+        return found;
+
+    hypatia::getLazy<CityGrid>().forEachId(MathOps::toRadians(_lng), MathOps::toRadians(_lat), _radius_km / GeoOps::EARTH_EQUATORIAL_RADIUS_KM, [&](int _i) {
+        double dist = GeoOps::distance(_lng, _lat, cities_loc[_i][1], cities_loc[_i][0]);
+        if (dist <= _radius_km)
+            found.push_back( CityDistance{ dist, (size_t)_i } );
+    });
+
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+}
+
+/**
+ * findClosestCity() - closest city to a location
+ *
+ * Only the cells of the city grid around the location are searched. The
+ * distances are the same haversine ones of distance(), so the result is the
+ * one of checking every city.
+ *
+ * @param _lng - longitude (degrees)
+ * @param _lat - latitude (degrees)
+ *
+ * @return city index, 0 if there is none closer than 50 km
+ */
 size_t GeoOps::findClosestCity(double _lng, double _lat) {
-    double minDist = 50.0;
+    double minDist = CITY_MAX_DISTANCE;
     size_t minIndex = 0;
-    for (size_t i = 0; i < CITIES_TOTAL; ++i) {
-        double dist = distance(_lng, _lat, cities_loc[i][1] , cities_loc[i][0]);
-        if (dist < minDist && dist < 1000.0) {
+    hypatia::getLazy<CityGrid>().forEachId(MathOps::toRadians(_lng), MathOps::toRadians(_lat), CITY_MAX_DISTANCE / EARTH_EQUATORIAL_RADIUS_KM, [&](int _i) {
+        double dist = distance(_lng, _lat, cities_loc[_i][1] , cities_loc[_i][0]);
+        if (dist < minDist || (dist == minDist && (size_t)_i < minIndex && minIndex != 0)) {
             minDist = dist;
-            minIndex = i;
+            minIndex = _i;
         }
-    }
+    });
     return minIndex;
 }
 
@@ -192,6 +252,60 @@ size_t GeoOps::findClosestCity(const Geodetic& _g) {
     return findClosestCity(_g.getLongitude(DEGS), _g.getLatitude(DEGS));
 }
 
+std::vector<size_t> GeoOps::findClosestCity(const std::vector<Geodetic>& _g) {
+    std::vector<size_t> cities(_g.size());
+    for (size_t i = 0; i < _g.size(); i++)
+        cities[i] = findClosestCity(_g[i]);
+    return cities;
+}
+
+/**
+ * findClosestCities() - closest cities to a location
+ *
+ * The search circle starts at 50 km and doubles until it holds _k cities.
+ *
+ * @param _lng - longitude (degrees)
+ * @param _lat - latitude (degrees)
+ * @param _k - number of cities
+ *
+ * @return up to _k city indices, closest first (ties by index)
+ */
+std::vector<size_t> GeoOps::findClosestCities(double _lng, double _lat, size_t _k) {
+    std::vector<size_t> cities;
+    if (_k == 0)
+        return cities;
+
+    std::vector<CityDistance> found;
+    for (double radius = CITY_MAX_DISTANCE; ; radius *= 2.0) {
+        // past half the circumference the circle holds the whole Earth
+        bool everywhere = radius >= EARTH_EQUATORIAL_HALF_CIRCUMFERENCE_M * 0.001;
+        found = citiesWithin(_lng, _lat, everywhere ? HUGE_VAL : radius);
+        if (found.size() >= _k || everywhere)
+            break;
+    }
+
+    for (size_t i = 0; i < found.size() && i < _k; i++)
+        cities.push_back(found[i].index);
+    return cities;
+}
+
+/**
+ * findCitiesWithin() - cities around a location
+ *
+ * @param _lng - longitude (degrees)
+ * @param _lat - latitude (degrees)
+ * @param _radius_km - distance to the location (km)
+ *
+ * @return city indices no further than _radius_km, closest first (ties by index)
+ */
+std::vector<size_t> GeoOps::findCitiesWithin(double _lng, double _lat, double _radius_km) {
+    std::vector<CityDistance> found = citiesWithin(_lng, _lat, _radius_km);
+    std::vector<size_t> cities(found.size());
+    for (size_t i = 0; i < found.size(); i++)
+        cities[i] = found[i].index;
+    return cities;
+}
+
 
 std::string GeoOps::getCityName(size_t _index) {
     if (_index < CITIES_TOTAL) {
@@ -223,8 +337,6 @@ size_t  GeoOps::getCityCountryIndex(size_t _index) {
 
 std::string GeoOps::getCityCountry(size_t _index) {
     if (_index < CITIES_TOTAL) {
-        std::cout << "City index: " << _index << std::endl;
-        std::cout << "Country index: " << getCityCountryIndex(_index) << std::endl;
         return getCountryName( getCityCountryIndex(_index) );
     }
     return "unknown";
@@ -279,40 +391,172 @@ std::string toLower(const std::string& _string) {
     return std;
 }
 
+namespace {
+
+// Lowercase city names, sorted, and lowercase country names and codes. Built once
+struct CityNames {
+    std::vector<std::string>    keys;       // lowercase city names, sorted
+    std::vector<size_t>         indices;    // city index of each key, ascending among equal keys
+    std::vector<std::string>    countries;  // lowercase country names
+    std::vector<std::string>    codes;      // lowercase country 2 letter codes
+
+    CityNames() {
+        std::vector< std::pair<std::string, size_t> > names(CITIES_N);
+        for (size_t i = 0; i < CITIES_N; i++)
+            names[i] = std::make_pair(toLower(cities[i]), i);
+        std::sort(names.begin(), names.end());
+
+        keys.resize(CITIES_N);
+        indices.resize(CITIES_N);
+        for (size_t i = 0; i < CITIES_N; i++) {
+            keys[i] = names[i].first;
+            indices[i] = names[i].second;
+        }
+
+        countries.resize(COUNTRIES_N);
+        codes.resize(COUNTRIES_N);
+        for (size_t i = 0; i < COUNTRIES_N; i++) {
+            countries[i] = toLower(::countries[i]);
+            codes[i] = toLower(countries_alpha2[i]);
+        }
+    }
+
+    // range of keys equal to _key
+    std::pair<size_t, size_t> exact( const std::string& _key ) const {
+        std::vector<std::string>::const_iterator lo = std::lower_bound(keys.begin(), keys.end(), _key);
+        std::vector<std::string>::const_iterator hi = std::upper_bound(lo, keys.end(), _key);
+        return std::make_pair(lo - keys.begin(), hi - keys.begin());
+    }
+
+    // range of keys starting with _prefix. Cut to the length of _prefix the keys are still
+    // sorted, so the end is a second binary search comparing only that many characters
+    std::pair<size_t, size_t> prefix( const std::string& _prefix ) const {
+        std::vector<std::string>::const_iterator lo = std::lower_bound(keys.begin(), keys.end(), _prefix);
+        std::vector<std::string>::const_iterator hi = std::upper_bound(lo, keys.end(), _prefix, [](const std::string& _p, const std::string& _key) {
+            return _key.compare(0, _p.size(), _p) > 0;
+        });
+        return std::make_pair(lo - keys.begin(), hi - keys.begin());
+    }
+
+    // whether _country (lowercase) is the name or the 2 letter code of the city's country
+    bool inCountry( size_t _city, const std::string& _country ) const {
+        size_t country = cities_country[_city];
+        return country < COUNTRIES_N && (countries[country] == _country || codes[country] == _country);
+    }
+};
+
+
+}
+
+/**
+ * findCity() - city named at the start of a place
+ *
+ * The place must start with the city name, followed by a space or nothing.
+ * Longer names win, and a city whose country name also appears in the place
+ * wins over the others. Only the names that are a prefix of the place are
+ * looked up in the sorted name index.
+ *
+ * @param _place - place, like "Paris France" (case insensitive)
+ *
+ * @return city index, 0 if none matches
+ */
 size_t GeoOps::findCity(const std::string& _place) {
+    const CityNames& names = hypatia::getLazy<CityNames>();
     std::string place_lower = toLower(_place);
 
     size_t best_idx  = 0;
     size_t best_score = 0;
 
-    for (size_t i = 0; i < GeoOps::CITIES_TOTAL; i++) {
-        std::string city_lower = toLower(GeoOps::getCityName(i));
-        size_t city_len = city_lower.size();
-
+    for (size_t len = 0; len <= place_lower.size(); len++) {
         // Place must start with the city name followed by a space or end of string
-        if (place_lower.size() < city_len)
-            continue;
-        if (place_lower.substr(0, city_len) != city_lower)
-            continue;
-        if (place_lower.size() != city_len && place_lower[city_len] != ' ')
+        if (len != place_lower.size() && place_lower[len] != ' ')
             continue;
 
-        int score = (int)city_len;
+        std::pair<size_t, size_t> range = names.exact( place_lower.substr(0, len) );
+        for (size_t k = range.first; k < range.second; k++) {
+            size_t i = names.indices[k];
+            size_t score = len;
 
-        // Bonus when the country name also appears in the place string
-        std::string country_lower = toLower(GeoOps::getCityCountry(i));
-        if (!country_lower.empty() && place_lower.find(country_lower) != std::string::npos)
-            score += 100;
+            // Bonus when the country name also appears in the place string
+            const std::string& country_lower = names.countries[ cities_country[i] ];
+            if (!country_lower.empty() && place_lower.find(country_lower) != std::string::npos)
+                score += 100;
 
-        if (score > best_score) {
-            best_score = score;
-            best_idx   = i;
+            // equal scores go to the first city of the table
+            if (score > best_score || (score == best_score && score > 0 && i < best_idx)) {
+                best_score = score;
+                best_idx   = i;
+            }
         }
     }
 
     return best_idx;
 }
 
+/**
+ * findCity() - city by name within a country
+ *
+ * @param _name - city name (case insensitive)
+ * @param _country - country name or 2 letter code (case insensitive)
+ *
+ * @return index of the first city in the table with that name and country, 0 if there is none
+ */
+size_t GeoOps::findCity(const std::string& _name, const std::string& _country) {
+    const CityNames& names = hypatia::getLazy<CityNames>();
+    std::string country_lower = toLower(_country);
+
+    std::pair<size_t, size_t> range = names.exact( toLower(_name) );
+    for (size_t k = range.first; k < range.second; k++) {
+        if (names.inCountry(names.indices[k], country_lower))
+            return names.indices[k];
+    }
+    return 0;
+}
+
+/**
+ * findCities() - every city with a name
+ *
+ * @param _name - city name (case insensitive)
+ *
+ * @return city indices in table order
+ */
+std::vector<size_t> GeoOps::findCities(const std::string& _name) {
+    const CityNames& names = hypatia::getLazy<CityNames>();
+    std::pair<size_t, size_t> range = names.exact( toLower(_name) );
+    return std::vector<size_t>(names.indices.begin() + range.first, names.indices.begin() + range.second);
+}
+
+/**
+ * autocompleteCity() - cities whose name starts with a prefix
+ *
+ * The tables have no population, so the best completions are the shortest
+ * names (the closest to what was typed), then the first in table order.
+ *
+ * @param _prefix - start of the city name (case insensitive)
+ * @param _max - most cities returned
+ *
+ * @return up to _max city indices, best first
+ */
+std::vector<size_t> GeoOps::autocompleteCity(const std::string& _prefix, size_t _max) {
+    const CityNames& names = hypatia::getLazy<CityNames>();
+    std::pair<size_t, size_t> range = names.prefix( toLower(_prefix) );
+
+    std::vector<size_t> found(names.indices.begin() + range.first, names.indices.begin() + range.second);
+    auto better = [&](size_t _a, size_t _b) {
+        size_t lenA = strlen(cities[_a]);
+        size_t lenB = strlen(cities[_b]);
+        return (lenA != lenB) ? lenA < lenB : _a < _b;
+    };
+
+    if (found.size() > _max) {
+        std::partial_sort(found.begin(), found.begin() + _max, found.end(), better);
+        found.resize(_max);
+    }
+    else
+        std::sort(found.begin(), found.end(), better);
+    return found;
+}
+
 double CalculateESquared(double a, double b) {
     return ((a * a) - (b * b)) / (a * a);
 }
@@ -0,0 +1,22 @@
+/*****************************************************************************\
+ * Lazy.h
+ *
+ * Internal helper for the lookup tables built from the compiled in data
+ * (city grid and names, star indices, constellation raster, VSOP87 series
+ * tables). Not installed.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+namespace hypatia {
+
+// The one T of the program, built on first use. Concurrent first calls wait for
+// the construction (function local statics are thread safe since C++11)
+template<class T>
+const T& getLazy() {
+    static const T instance;
+    return instance;
+}
+
+}
@@ -15,6 +15,7 @@
 #include "hypatia/CoordOps.h"
 
 #include "hypatia/Body.h"
+#include "hypatia/SolarSystemSnapshot.h"
 #include "hypatia/models/VSOP87.h"
 
 #include <stdlib.h>
@@ -214,7 +215,7 @@ const LunarTerms2 LunarLat[60] = {
     { 2, -2,  0,  1,     107 }
 };
 
-Luna::Luna(): m_age(0.0), m_posAngle(0.0) {
+Luna::Luna(): m_evaluation(DIRECT), m_age(0.0), m_posAngle(0.0) {
     m_bodyId = LUNA;
 }
 
@@ -287,232 +288,655 @@ double getFund( const double* tptr, double _jcentury ) {
 }
 
 /**
- * Luna::compute() - compute all lunar quantities for the given Observer.
+ * getFundRate() - derivative of the polynomial of getFund()
+ *
+ * @param tptr     - pointer to 5-element coefficient array (degrees)
+ * @param _jcentury - Julian centuries from J2000.0 (T)
+ *
+ * @return rate of the fundamental argument in radians per julian century
+ */
+static double getFundRate( const double* tptr, double _jcentury ) {
+    double d = 0.;
+    double tpow = 1.;
+    for (int i=1; i<=4; i++) {
+        d += i * tpow * tptr[i];
+        tpow *= _jcentury;
+    }
+    return MathOps::toRadians( d );
+}
+
+// largest multiple of D, M, M' and F in the series
+static const int N_MULTIPLES = 4;
+
+/**
+ * sin/cos of the multiples 0...N_MULTIPLES of the four fundamental arguments,
+ * built from one sin()/cos() each by the Chebyshev recurrence
+ *
+ *   cos(kx) = 2 cos(x) cos((k-1)x) - cos((k-2)x)
+ *   sin(kx) = 2 cos(x) sin((k-1)x) - sin((k-2)x)
+ */
+struct MultipleAngles {
+    double cosD[N_MULTIPLES + 1], sinD[N_MULTIPLES + 1];
+    double cosM[N_MULTIPLES + 1], sinM[N_MULTIPLES + 1];
+    double cosMp[N_MULTIPLES + 1], sinMp[N_MULTIPLES + 1];
+    double cosF[N_MULTIPLES + 1], sinF[N_MULTIPLES + 1];
+
+    MultipleAngles( const LunarFundamentals& _f ) {
+        fill( _f.D, cosD, sinD );
+        fill( _f.M, cosM, sinM );
+        fill( _f.Mp, cosMp, sinMp );
+        fill( _f.F, cosF, sinF );
+    }
+
+    static void fill( double _angle, double* _cos, double* _sin ) {
+        _cos[0] = 1.;
+        _sin[0] = 0.;
+        _cos[1] = cos( _angle );
+        _sin[1] = sin( _angle );
+        for (int k = 2; k <= N_MULTIPLES; k++) {
+            _cos[k] = 2. * _cos[1] * _cos[k-1] - _cos[k-2];
+            _sin[k] = 2. * _cos[1] * _sin[k-1] - _sin[k-2];
+        }
+    }
+
+    // multiply the complex number (_cos, _sin) by exp( i k x )
+    static inline void rotate( int _k, const double* _cosX, const double* _sinX, double& _cos, double& _sin ) {
+        if (_k == 0)
+            return;
+
+        double c = _cosX[abs(_k)];
+        double s = (_k < 0) ? -_sinX[-_k] : _sinX[_k];
+        double r = _cos * c - _sin * s;
+        _sin = _cos * s + _sin * c;
+        _cos = r;
+    }
+
+    // cos and sin of d*D + m*M + mp*M' + f*F
+    inline void eval( int _d, int _m, int _mp, int _f, double& _cos, double& _sin ) const {
+        _cos = 1.;
+        _sin = 0.;
+        rotate( _d, cosD, sinD, _cos, _sin );
+        rotate( _m, cosM, sinM, _cos, _sin );
+        rotate( _mp, cosMp, sinMp, _cos, _sin );
+        rotate( _f, cosF, sinF, _cos, _sin );
+    }
+};
+
+/**
+ * sumLatitude() - latitude series of calcGeocentric() from multiple angle tables
+ *
+ * @param _angles - sin/cos of the multiples of the fundamentals
+ * @param _e - eccentricity correction factor
+ *
+ * @return sum of the 60 terms (1e-6 degrees)
+ */
+static double sumLatitude( const MultipleAngles& _angles, double _e ) {
+    double rval = 0.;
+    for (int i = 0; i < N_LTERM2; i++) {
+        const LunarTerms2& t = LunarLat[i];
+        if (t.sb == 0)
+            continue;
+
+        double c, s;
+        _angles.eval( t.d, t.m, t.mp, t.f, c, s );
+
+        double term = (double)(t.sb) * s;
+        for( int j = abs(t.m); j!=0; j-- )
+            term *= _e;
+        rval += term;
+    }
+    return rval;
+}
+
+/**
+ * sumLongitudeRadius() - longitude and radius series of calcGeocentric() from
+ * multiple angle tables
+ *
+ * @param _angles - sin/cos of the multiples of the fundamentals
+ * @param _e - eccentricity correction factor
+ * @param _sl - [in/out] longitude sum (1e-6 degrees)
+ * @param _sr - [in/out] radius sum (meters)
+ */
+static void sumLongitudeRadius( const MultipleAngles& _angles, double _e, double& _sl, double& _sr ) {
+    for (int i = 0; i < N_LTERM1; i++) {
+        const LunarTerms1& t = LunarLonRad[i];
+        if (t.sl == 0 && t.sr == 0)
+            continue;
+
+        double c, s;
+        _angles.eval( t.d, t.m, t.mp, t.f, c, s );
+
+        double eFactor = 1.;
+        for( int j = abs(t.m); j!=0; j-- )
+            eFactor *= _e;
+
+        _sl += (double)(t.sl) * s * eFactor;
+        _sr += (double)(t.sr) * c * eFactor;
+    }
+}
+
+/**
+ * sumMultipleAngle() - the series of Luna::calcGeocentric() evaluated from
+ * multiple angle tables, with the same additional terms.
+ *
+ * Agrees with the DIRECT evaluation within 1e-12 radians but not bit for bit,
+ * which is why DIRECT stays the default: results of existing callers (and the
+ * values tests were recorded with) don't change unless this is asked for.
+ *
+ * @param _f - lunar fundamentals
+ * @param _lng - [out] longitude (radians)
+ * @param _lat - [out] latitude (radians)
+ * @param _rad - [out] distance (km)
+ */
+static void sumMultipleAngle( const LunarFundamentals& _f, double& _lng, double& _lat, double& _rad ) {
+    const MultipleAngles angles(_f);
+    const double e = 1. - .002516 * _f.T - .0000074 * _f.T * _f.T;
+
+    double rval = sumLatitude( angles, e );
+    rval +=   -2235. * sin( _f.Lp ) +
+               382.  * sin( _f.A3 ) +
+               175.  * sin( _f.A1 - _f.F ) +
+               175.  * sin( _f.A1 + _f.F ) +
+               127.  * sin( _f.Lp - _f.Mp ) -
+               115.  * sin( _f.Lp + _f.Mp );
+
+    _lat = MathOps::toRadians(rval * 1.e-6);
+
+    double sl = 0., sr = 0.;
+    sumLongitudeRadius( angles, e, sl, sr );
+    sl += 3958. * sin( _f.A1 ) +
+          1962. * sin( _f.Lp - _f.F ) +
+          318.  * sin( _f.A2 );
+
+    _lng = (_f.Lp * 180. / MathOps::PI) + sl * 1.e-6;
+    _lng = MathOps::toRadians(MathOps::normalize( _lng, DEGS ));
+
+    _rad = 385000.56 + sr * 0.001; // Km
+}
+
+/**
+ * Luna::calcGeocentric() - ecliptic geocentric position of the moon
  *
  * Implements the ELP2000-82 truncated series (Meeus, Astronomical Algorithms
  * Chapter 47) with 60-term longitude/radius series and 60-term latitude series.
  *
- * Computed quantities (cached until JC changes):
- *   - m_geocentric  : ecliptic geocentric position (lng, lat, distance in km)
- *   - m_heliocentric: ecliptic heliocentric position
- *   - m_equatorial  : equatorial RA/Dec
- *   - m_horizontal  : altitude/azimuth (only if observer has a location)
- *   - m_distance    : geocentric distance in km
- *   - m_age         : Moon age in days within the synodic month
- *   - m_posAngle    : illumination position angle (radians)
- *   - m_ha          : hour angle (radians)
- *
  * The eccentricity correction factor e = 1 - 0.002516*T - 0.0000074*T² is
  * applied to terms that involve the solar mean anomaly M (|m| == 1 multiplied
  * once, |m| == 2 multiplied twice).
  *
- * @param _obs - Observer carrying JD, location, obliquity, and LST
+ * @param _jcentury - time in julian centuries
+ * @param _f - [out] lunar fundamentals at _jcentury
+ * @param _lng - [out] longitude (radians)
+ * @param _lat - [out] latitude (radians)
+ * @param _rad - [out] distance (km)
+ * @param _evaluation - DIRECT or MULTIPLE_ANGLE (see sumMultipleAngle())
  */
-void Luna::compute( Observer &_obs ) {
-    if (m_jcentury != _obs.getJC()) {
-        m_jcentury = _obs.getJC();
-
-        m_f.Lp = getFund( LunarFundimentals_Lp, m_jcentury );
-        m_f.D = getFund( LunarFundimentals_D, m_jcentury );
-        m_f.M = getFund( LunarFundimentals_M, m_jcentury );
-        m_f.Mp = getFund( LunarFundimentals_Mp, m_jcentury );
-        m_f.F = getFund( LunarFundimentals_F, m_jcentury );
-
-        m_f.A1 = MathOps::toRadians( MathOps::normalize( 119.75 + 131.849 * m_jcentury, DEGS ));
-        m_f.A2 = MathOps::toRadians( MathOps::normalize( 53.09 + 479264.290 * m_jcentury, DEGS ));
-        m_f.A3 = MathOps::toRadians( MathOps::normalize( 313.45 + 481266.484 * m_jcentury, DEGS ));
-        m_f.T  = MathOps::toRadians( MathOps::normalize( m_jcentury, DEGS ));
-
-        double lng, lat, rad = 0.0;
-        {
-            // Compute Ecliptic Geocentric Latitud
-            const LunarTerms2* tptr = LunarLat;
-            double rval = 0.;
-
-            const double e = 1. - .002516 * m_f.T - .0000074 * m_f.T * m_f.T;
-
-            for( int i=N_LTERM2; i!=0; i-- ) {
-
-                if( labs( tptr->sb ) > 0. ) {
-                    double arg;
-
-                    switch( tptr->d ) {
-                        case  1:   arg = m_f.D;          break;
-                        case -1:   arg =-m_f.D;          break;
-                        case  2:   arg = m_f.D+m_f.D;    break;
-                        case -2:   arg =-m_f.D-m_f.D;    break;
-                        case  0:   arg = 0.;             break;
-                        default:   arg = (double)(tptr->d) * m_f.D;  break;
-                    }
-
-                    switch( tptr->m ) {
-                        case  1:   arg += m_f.M;         break;
-                        case -1:   arg -= m_f.M;         break;
-                        case  2:   arg += m_f.M+m_f.M;   break;
-                        case -2:   arg -= m_f.M+m_f.M;   break;
-                        case  0:           ;             break;
-                        default:   arg += (double)(tptr->m) * m_f.M;  break;
-                    }
-
-                    switch( tptr->mp ) {
-                        case  1:   arg += m_f.Mp;        break;
-                        case -1:   arg -= m_f.Mp;        break;
-                        case  2:   arg += m_f.Mp+m_f.Mp; break;
-                        case -2:   arg -= m_f.Mp+m_f.Mp; break;
-                        case  0:           ;             break;
-                        default:   arg += (double)(tptr->mp) * m_f.Mp;  break;
-                    }
-
-                    switch( tptr->f ) {
-                        case  1:   arg += m_f.F;         break;
-                        case -1:   arg -= m_f.F;         break;
-                        case  2:   arg += m_f.F+m_f.F;   break;
-                        case -2:   arg -= m_f.F+m_f.F;   break;
-                        case  0:           ;             break;
-                        default:   arg += (double)(tptr->f) * m_f.F;  break;
-                    }
-
-                    double term = (double)(tptr->sb) * sin( arg );
-                    for( int j = abs(tptr->m); j!=0; j-- )
-                        term *= e;
+void Luna::calcGeocentric( double _jcentury, LunarFundamentals& _f, double& _lng, double& _lat, double& _rad, Evaluation _evaluation ) {
+    calcFundamentals( _jcentury, _f );
+
+    if (MULTIPLE_ANGLE == _evaluation) {
+        sumMultipleAngle( _f, _lng, _lat, _rad );
+        return;
+    }
+
+    {
+        // Compute Ecliptic Geocentric Latitud
+        const LunarTerms2* tptr = LunarLat;
+        double rval = 0.;
+
+        const double e = 1. - .002516 * _f.T - .0000074 * _f.T * _f.T;
+
+        for( int i=N_LTERM2; i!=0; i-- ) {
 
-                    rval += term;
+            if( labs( tptr->sb ) > 0. ) {
+                double arg;
+
+                switch( tptr->d ) {
+                    case  1:   arg = _f.D;           break;
+                    case -1:   arg =-_f.D;           break;
+                    case  2:   arg = _f.D+_f.D;      break;
+                    case -2:   arg =-_f.D-_f.D;      break;
+                    case  0:   arg = 0.;             break;
+                    default:   arg = (double)(tptr->d) * _f.D;  break;
+                }
+
+                switch( tptr->m ) {
+                    case  1:   arg += _f.M;          break;
+                    case -1:   arg -= _f.M;          break;
+                    case  2:   arg += _f.M+_f.M;     break;
+                    case -2:   arg -= _f.M+_f.M;     break;
+                    case  0:           ;             break;
+                    default:   arg += (double)(tptr->m) * _f.M;  break;
+                }
+
+                switch( tptr->mp ) {
+                    case  1:   arg += _f.Mp;         break;
+                    case -1:   arg -= _f.Mp;         break;
+                    case  2:   arg += _f.Mp+_f.Mp;   break;
+                    case -2:   arg -= _f.Mp+_f.Mp;   break;
+                    case  0:           ;             break;
+                    default:   arg += (double)(tptr->mp) * _f.Mp;  break;
+                }
+
+                switch( tptr->f ) {
+                    case  1:   arg += _f.F;          break;
+                    case -1:   arg -= _f.F;          break;
+                    case  2:   arg += _f.F+_f.F;     break;
+                    case -2:   arg -= _f.F+_f.F;     break;
+                    case  0:           ;             break;
+                    default:   arg += (double)(tptr->f) * _f.F;  break;
                 }
-                tptr++;
+
+                double term = (double)(tptr->sb) * sin( arg );
+                for( int j = abs(tptr->m); j!=0; j-- )
+                    term *= e;
+
+                rval += term;
             }
-            // Additional latitude correction terms (Meeus Ch.47, Table 47.b)
-            // These corrections are applied once, after summing the 60-term series.
-            rval +=   -2235. * sin( m_f.Lp ) +
-                       382.  * sin( m_f.A3 ) +
-                       175.  * sin( m_f.A1 - m_f.F ) +
-                       175.  * sin( m_f.A1 + m_f.F ) +
-                       127.  * sin( m_f.Lp - m_f.Mp ) -
-                       115.  * sin( m_f.Lp + m_f.Mp );
-
-            lat = MathOps::toRadians(rval * 1.e-6);
+            tptr++;
         }
+        // Additional latitude correction terms (Meeus Ch.47, Table 47.b)
+        // These corrections are applied once, after summing the 60-term series.
+        rval +=   -2235. * sin( _f.Lp ) +
+                   382.  * sin( _f.A3 ) +
+                   175.  * sin( _f.A1 - _f.F ) +
+                   175.  * sin( _f.A1 + _f.F ) +
+                   127.  * sin( _f.Lp - _f.Mp ) -
+                   115.  * sin( _f.Lp + _f.Mp );
+
+        _lat = MathOps::toRadians(rval * 1.e-6);
+    }
+
+    {
+        // Compute Ecliptic Geocentric Longitude and radius
+        const LunarTerms1* tptr = LunarLonRad;
+
+        double sl = 0., sr = 0.;
+        const double e = 1. - .002516 * _f.T - .0000074 * _f.T * _f.T;
+
+        for( int i=N_LTERM1; i!=0; i-- ) {
+            if( labs( tptr->sl ) > 0 || labs( tptr->sr ) > 0 ) {
+                double arg;
 
-        {
-            // Compute Ecliptic Geocentric Longitude and radius
-            const LunarTerms1* tptr = LunarLonRad;
-
-            double sl = 0., sr = 0.;
-            const double e = 1. - .002516 * m_f.T - .0000074 * m_f.T * m_f.T;
-
-            for( int i=N_LTERM1; i!=0; i-- ) {
-                if( labs( tptr->sl ) > 0 || labs( tptr->sr ) > 0 ) {
-                    double arg;
-
-                    switch( tptr->d ){
-                        case  1:   arg = m_f.D;          break;
-                        case -1:   arg =-m_f.D;          break;
-                        case  2:   arg = m_f.D+m_f.D;    break;
-                        case -2:   arg =-m_f.D-m_f.D;    break;
-                        case  0:   arg = 0.;             break;
-                        default:   arg = (double)(tptr->d) * m_f.D;  break;
-                    }
-
-                    switch( tptr->m ){
-                        case  1:   arg += m_f.M;         break;
-                        case -1:   arg -= m_f.M;         break;
-                        case  2:   arg += m_f.M+m_f.M;   break;
-                        case -2:   arg -= m_f.M+m_f.M;   break;
-                        case  0:           ;             break;
-                        default:   arg += (double)(tptr->m) * m_f.M;  break;
-                    }
-
-                    switch( tptr->mp ){
-                        case  1:   arg += m_f.Mp;        break;
-                        case -1:   arg -= m_f.Mp;        break;
-                        case  2:   arg += m_f.Mp+m_f.Mp; break;
-                        case -2:   arg -= m_f.Mp+m_f.Mp; break;
-                        case  0:           ;             break;
-                        default:   arg += (double)(tptr->mp) * m_f.Mp;  break;
-                    }
-
-                    switch( tptr->f ){
-                        case  1:   arg += m_f.F;         break;
-                        case -1:   arg -= m_f.F;         break;
-                        case  2:   arg += m_f.F+m_f.F;   break;
-                        case -2:   arg -= m_f.F+m_f.F;   break;
-                        case  0:           ;             break;
-                        default:   arg += (double)(tptr->f) * m_f.F;  break;
-                    }
-
-                    if ( tptr->sl ){
-                        double term = (double)(tptr->sl) * sin(arg);
-                        for( int j=abs(tptr->m); j!=0; j-- )
-                            term *= e;
-                        sl += term;
-                    }
-
-                    if ( tptr->sr ){
-                        double term = (double)(tptr->sr) * cos(arg);
-                        for( int j=abs(tptr->m); j!=0; j-- )
-                            term *= e;
-                        sr += term;
-                    }
+                switch( tptr->d ){
+                    case  1:   arg = _f.D;           break;
+                    case -1:   arg =-_f.D;           break;
+                    case  2:   arg = _f.D+_f.D;      break;
+                    case -2:   arg =-_f.D-_f.D;      break;
+                    case  0:   arg = 0.;             break;
+                    default:   arg = (double)(tptr->d) * _f.D;  break;
+                }
+
+                switch( tptr->m ){
+                    case  1:   arg += _f.M;          break;
+                    case -1:   arg -= _f.M;          break;
+                    case  2:   arg += _f.M+_f.M;     break;
+                    case -2:   arg -= _f.M+_f.M;     break;
+                    case  0:           ;             break;
+                    default:   arg += (double)(tptr->m) * _f.M;  break;
                 }
-                tptr++;
-            }
 
-            sl += 3958. * sin( m_f.A1 ) +
-                  1962. * sin( m_f.Lp - m_f.F ) +
-                  318.  * sin( m_f.A2 );
+                switch( tptr->mp ){
+                    case  1:   arg += _f.Mp;         break;
+                    case -1:   arg -= _f.Mp;         break;
+                    case  2:   arg += _f.Mp+_f.Mp;   break;
+                    case -2:   arg -= _f.Mp+_f.Mp;   break;
+                    case  0:           ;             break;
+                    default:   arg += (double)(tptr->mp) * _f.Mp;  break;
+                }
 
-            lng = (m_f.Lp * 180. / MathOps::PI) + sl * 1.e-6;
-            lng = MathOps::toRadians(MathOps::normalize( lng, DEGS ));
-            
-            rad = 385000.56 + sr * 0.001; // Km
+                switch( tptr->f ){
+                    case  1:   arg += _f.F;          break;
+                    case -1:   arg -= _f.F;          break;
+                    case  2:   arg += _f.F+_f.F;     break;
+                    case -2:   arg -= _f.F+_f.F;     break;
+                    case  0:           ;             break;
+                    default:   arg += (double)(tptr->f) * _f.F;  break;
+                }
+
+                if ( tptr->sl ){
+                    double term = (double)(tptr->sl) * sin(arg);
+                    for( int j=abs(tptr->m); j!=0; j-- )
+                        term *= e;
+                    sl += term;
+                }
+
+                if ( tptr->sr ){
+                    double term = (double)(tptr->sr) * cos(arg);
+                    for( int j=abs(tptr->m); j!=0; j-- )
+                        term *= e;
+                    sr += term;
+                }
+            }
+            tptr++;
         }
-    
-        m_distance = rad;
-        m_geocentric = Ecliptic(lng, lat, rad, RADS, KM);
+
+        sl += 3958. * sin( _f.A1 ) +
+              1962. * sin( _f.Lp - _f.F ) +
+              318.  * sin( _f.A2 );
+
+        _lng = (_f.Lp * 180. / MathOps::PI) + sl * 1.e-6;
+        _lng = MathOps::toRadians(MathOps::normalize( _lng, DEGS ));
         
-        m_equatorial = CoordOps::toEquatorial( _obs, m_geocentric );
+        _rad = 385000.56 + sr * 0.001; // Km
+    }
+}
+
+/**
+ * Luna::calcFundamentals() - fundamental arguments of the lunar series
+ *
+ * @param _jcentury - time in julian centuries
+ * @param _f - [out] lunar fundamentals at _jcentury
+ */
+void Luna::calcFundamentals( double _jcentury, LunarFundamentals& _f ) {
+    _f.Lp = getFund( LunarFundimentals_Lp, _jcentury );
+    _f.D = getFund( LunarFundimentals_D, _jcentury );
+    _f.M = getFund( LunarFundimentals_M, _jcentury );
+    _f.Mp = getFund( LunarFundimentals_Mp, _jcentury );
+    _f.F = getFund( LunarFundimentals_F, _jcentury );
+
+    _f.A1 = MathOps::toRadians( MathOps::normalize( 119.75 + 131.849 * _jcentury, DEGS ));
+    _f.A2 = MathOps::toRadians( MathOps::normalize( 53.09 + 479264.290 * _jcentury, DEGS ));
+    _f.A3 = MathOps::toRadians( MathOps::normalize( 313.45 + 481266.484 * _jcentury, DEGS ));
+    _f.T  = MathOps::toRadians( MathOps::normalize( _jcentury, DEGS ));
+}
+
+/**
+ * Luna::calcGeocentricRates() - derivatives of the series of calcGeocentric()
+ *
+ * Every term c x sin( arg ) x e^|m| is differentiated in closed form,
+ * c x ( cos( arg ) x arg' x e^|m| + sin( arg ) x |m| x e^(|m|-1) x e' ), with
+ * the sin/cos of the arguments taken from the multiple angle tables. The
+ * series are not evaluated again.
+ *
+ * @param _jcentury - time in julian centuries
+ * @param _f - lunar fundamentals at _jcentury
+ * @param _dLng - [out] longitude rate (radians per julian century)
+ * @param _dLat - [out] latitude rate (radians per julian century)
+ * @param _dRad - [out] distance rate (km per julian century)
+ */
+void Luna::calcGeocentricRates( double _jcentury, const LunarFundamentals& _f, double& _dLng, double& _dLat, double& _dRad ) {
+    // rates of the fundamentals (radians per julian century)
+    const double dLp = getFundRate( LunarFundimentals_Lp, _jcentury );
+    const double dD = getFundRate( LunarFundimentals_D, _jcentury );
+    const double dM = getFundRate( LunarFundimentals_M, _jcentury );
+    const double dMp = getFundRate( LunarFundimentals_Mp, _jcentury );
+    const double dF = getFundRate( LunarFundimentals_F, _jcentury );
+    const double dA1 = MathOps::toRadians( 131.849 );
+    const double dA2 = MathOps::toRadians( 479264.290 );
+    const double dA3 = MathOps::toRadians( 481266.484 );
+
+    // eccentricity factor of calcGeocentric() and its rate (_f.T is in radians)
+    const double e = 1. - .002516 * _f.T - .0000074 * _f.T * _f.T;
+    const double dE = ( -.002516 - 2. * .0000074 * _f.T ) * MathOps::toRadians( 1. );
+
+    const MultipleAngles angles(_f);
+
+    double dSb = 0.;
+    for (int i = 0; i < N_LTERM2; i++) {
+        const LunarTerms2& t = LunarLat[i];
+        if (t.sb == 0)
+            continue;
+
+        double c, s;
+        angles.eval( t.d, t.m, t.mp, t.f, c, s );
+        const double dArg = t.d * dD + t.m * dM + t.mp * dMp + t.f * dF;
+
+        double eFactor = 1., dEFactor = 0.;
+        for( int j = abs(t.m); j!=0; j-- ) {
+            dEFactor = dEFactor * e + eFactor * dE;
+            eFactor *= e;
+        }
+
+        dSb += (double)(t.sb) * ( c * dArg * eFactor + s * dEFactor );
+    }
+
+    dSb +=  -2235. * cos( _f.Lp ) * dLp +
+             382.  * cos( _f.A3 ) * dA3 +
+             175.  * cos( _f.A1 - _f.F ) * ( dA1 - dF ) +
+             175.  * cos( _f.A1 + _f.F ) * ( dA1 + dF ) +
+             127.  * cos( _f.Lp - _f.Mp ) * ( dLp - dMp ) -
+             115.  * cos( _f.Lp + _f.Mp ) * ( dLp + dMp );
+
+    double dSl = 0., dSr = 0.;
+    for (int i = 0; i < N_LTERM1; i++) {
+        const LunarTerms1& t = LunarLonRad[i];
+        if (t.sl == 0 && t.sr == 0)
+            continue;
+
+        double c, s;
+        angles.eval( t.d, t.m, t.mp, t.f, c, s );
+        const double dArg = t.d * dD + t.m * dM + t.mp * dMp + t.f * dF;
+
+        double eFactor = 1., dEFactor = 0.;
+        for( int j = abs(t.m); j!=0; j-- ) {
+            dEFactor = dEFactor * e + eFactor * dE;
+            eFactor *= e;
+        }
+
+        dSl += (double)(t.sl) * ( c * dArg * eFactor + s * dEFactor );
+        dSr += (double)(t.sr) * ( -s * dArg * eFactor + c * dEFactor );
+    }
+
+    dSl +=  3958. * cos( _f.A1 ) * dA1 +
+            1962. * cos( _f.Lp - _f.F ) * ( dLp - dF ) +
+            318.  * cos( _f.A2 ) * dA2;
+
+    _dLat = MathOps::toRadians( dSb * 1.e-6 );
+    _dLng = dLp + MathOps::toRadians( dSl * 1.e-6 );
+    _dRad = dSr * 0.001;
+}
+
+/**
+ * Luna::computeGeocentricVelocity() - geocentric velocity of the moon
+ *
+ * @param _jcentury - time in julian centuries
+ * @param _geocentric - position at _jcentury, as returned by computeGeocentric()
+ *
+ * @return ecliptic velocity (AU per day)
+ */
+Vector3 Luna::computeGeocentricVelocity( double _jcentury, const Ecliptic& _geocentric ) {
+    LunarFundamentals f;
+    calcFundamentals( _jcentury, f );
+
+    double dLng, dLat, dRad;
+    calcGeocentricRates( _jcentury, f, dLng, dLat, dRad );
+
+    const double perDay = 1. / TimeOps::DAYS_PER_CENTURY;
+    return CoordOps::toEclipticVelocity(_geocentric, dLng * perDay, dLat * perDay, dRad * CoordOps::KM_TO_AU * perDay);
+}
+
+/**
+ * Luna::computeGeocentric() - ecliptic geocentric position of the moon
+ *
+ * Stateless and reentrant: everything is computed on the stack, so Moon
+ * positions for many epochs can be computed in parallel.
+ *
+ * @param _jcentury - time in julian centuries
+ * @param _evaluation - DIRECT or MULTIPLE_ANGLE
+ *
+ * @return ecliptic geocentric position (distance in km)
+ */
+Ecliptic Luna::computeGeocentric( double _jcentury, Evaluation _evaluation ) {
+    LunarFundamentals f;
+    double lng, lat, rad = 0.0;
+    calcGeocentric(_jcentury, f, lng, lat, rad, _evaluation);
+    return Ecliptic(lng, lat, rad, RADS, KM);
+}
 
+/**
+ * Luna::computeGeocentric() - ecliptic geocentric position and velocity of the moon
+ *
+ * @param _jcentury - time in julian centuries
+ * @param _velocity - [out] ecliptic velocity (AU per day)
+ * @param _evaluation - DIRECT or MULTIPLE_ANGLE
+ *
+ * @return ecliptic geocentric position (distance in km)
+ */
+Ecliptic Luna::computeGeocentric( double _jcentury, Vector3& _velocity, Evaluation _evaluation ) {
+    Ecliptic geocentric = computeGeocentric(_jcentury, _evaluation);
+    _velocity = computeGeocentricVelocity(_jcentury, geocentric);
+    return geocentric;
+}
+
+/**
+ * Luna::compute() - compute all lunar quantities for the given Observer.
+ *
+ * Evaluates the series of calcGeocentric() and derives from it the
+ * quantities below.
+ *
+ * Computed quantities, by stage (see Body::compute()):
+ *   time stage (only when the observer's time changed):
+ *   - m_geocentric  : ecliptic geocentric position (lng, lat, distance in km)
+ *   - m_heliocentric: ecliptic heliocentric position
+ *   - m_equatorial  : equatorial RA/Dec
+ *   - m_distance    : geocentric distance in km
+ *   - m_age         : Moon age in days within the synodic month
+ *   location stage (when the observer's time or location changed):
+ *   - m_horizontal  : altitude/azimuth (only if observer has a location)
+ *   - m_posAngle    : illumination position angle (radians)
+ *   - m_ha          : hour angle (radians)
+ *
+ * @param _obs - Observer carrying JD, location, obliquity, and LST
+ */
+void Luna::compute( Observer &_obs ) {
+    if (syncTime(_obs)) {
         // Compute Sun's coords
         double sun_eclipticLon, sun_eclipticLat, sun_radius;
         VSOP87::calcAllLocs( sun_eclipticLon, sun_eclipticLat, sun_radius, _obs.getJC(), EARTH);
-        
-        // Get HelioCentric values
-        Ecliptic toEarth = Ecliptic(sun_eclipticLon, sun_eclipticLat, sun_radius, RADS, AU);
-        Vector3 Sun2Earth = toEarth.getVector(AU);
-        Vector3 Earth2Moon = m_geocentric.getVector(AU);
-        Vector3 Sun2Moon = Sun2Earth + Earth2Moon;
-        
-        m_heliocentric = CoordOps::toHeliocentric(_obs, m_geocentric);
-        
-        // Distance toSun from the Earth
-        sun_eclipticLon += MathOps::PI;
-        sun_eclipticLat *= -1.;
-        toEarth.invert();
-        Equatorial sunEq = CoordOps::toEquatorial( _obs, toEarth);
-        Horizontal sunHor = CoordOps::toHorizontal( _obs, sunEq);
-        
-        // Compute moon age
-        double moonAge = MathOps::normalize( MathOps::TAU - (sun_eclipticLon - m_geocentric.getLongitude(RADS)), RADS );
-
-        // convert radians to Synodic day
-        m_age = SYNODIC_MONTH * (moonAge / MathOps::TAU);
-
-        if (_obs.haveLocation()) {
-            m_horizontal = CoordOps::toHorizontal( _obs, m_equatorial );
-            // Position Angle
-            double delta_az = m_horizontal.getAzimuth(RADS) - sunHor.getAzimuth(RADS);
-            m_posAngle = atan2( cos(sunHor.getAltitud(RADS)) * sin(delta_az),
-                               sin(sunHor.getAltitud(RADS)) * cos(m_horizontal.getAzimuth(RADS)) - cos(sunHor.getAltitud(RADS)) * sin(m_horizontal.getAzimuth(RADS)) * cos(delta_az));
-            m_ha = MathOps::normalize(CoordOps::toHourAngle( _obs, m_equatorial ), RADS);
-            m_bHorizontal = true;
-        }
-        else {
-            m_ha = 0.0;
-            m_horizontal[0] = 0.0;
-            m_horizontal[1] = 0.0;
-            m_posAngle = 0.0;
-            m_bHorizontal = false;
-        }
+
+        computeFromEarth( _obs.getJC(), _obs.getObliquity(), Ecliptic(sun_eclipticLon, sun_eclipticLat, sun_radius, RADS, AU) );
+    }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+/**
+ * Luna::compute() - same as compute( Observer& ) taking Earth's heliocentric
+ *                   position from a shared EpochContext.
+ *
+ * Falls back to compute( Observer& ) when the context is for a different JD.
+ *
+ * @param _obs   - Observer carrying JD, location, obliquity, and LST
+ * @param _epoch - context computed at the observer's JD
+ */
+void Luna::compute( Observer &_obs, const EpochContext& _epoch ) {
+    if ( _epoch.getJD() != _obs.getJD() ) {
+        compute(_obs);
+        return;
+    }
+
+    if (syncTime(_obs)) {
+        computeFromEarth( _obs.getJC(), _epoch.getObliquity(), _epoch.getEarthHeliocentric() );
+    }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+/**
+ * Luna::compute() - same as compute( Observer& ) from an immutable ObserverState
+ *
+ * @param _state - state of the observer
+ */
+void Luna::compute( const ObserverState& _state ) {
+    if (syncTime(_state)) {
+        computeFromEarth( _state.getJC(), _state.getObliquity(), _state.getEarthHeliocentric() );
+    }
+
+    if (syncLocation(_state))
+        computeHorizontal(_state);
+}
+
+void Luna::compute( Observer &_obs, const SolarSystemSnapshot& _snapshot ) {
+    compute(_obs, _snapshot.getEpoch());
+}
+
+/**
+ * Luna::computeFromEarth() - time stage of compute(), given the Earth's
+ *                            heliocentric position at the observer's JD
+ *
+ * @param _jcentury  - julian centuries of the observer's JD
+ * @param _obliquity - obliquity of the ecliptic (radians)
+ * @param _earth     - ecliptic heliocentric position of the Earth
+ */
+void Luna::computeFromEarth( double _jcentury, double _obliquity, const Ecliptic& _earth ) {
+    m_jcentury = _jcentury;
+
+    double lng, lat, rad = 0.0;
+    calcGeocentric(m_jcentury, m_f, lng, lat, rad, m_evaluation);
+
+    m_distance = rad;
+    m_geocentric = Ecliptic(lng, lat, rad, RADS, KM);
+    m_bVelocity = false;
+    
+    m_equatorial = CoordOps::toEquatorial( _obliquity, m_geocentric.getLongitude(RADS), m_geocentric.getLatitude(RADS) );
+
+    // Sun's coords
+    double sun_eclipticLon = _earth.getLongitude(RADS);
+    double sun_eclipticLat = _earth.getLatitude(RADS);
+    
+    // Get HelioCentric values
+    Ecliptic toEarth = _earth;
+    hypatia::vec3 Sun2Earth = hypatia::toVector(toEarth.getCore());
+    hypatia::vec3 Earth2Moon = hypatia::toVector(m_geocentric.getCore());
+    
+    m_heliocentric = Ecliptic( hypatia::toEcliptic(Sun2Earth + Earth2Moon) );
+    
+    // Distance toSun from the Earth
+    sun_eclipticLon += MathOps::PI;
+    sun_eclipticLat *= -1.;
+    toEarth.invert();
+    m_sunEquatorial = CoordOps::toEquatorial( _obliquity, toEarth.getLongitude(RADS), toEarth.getLatitude(RADS) );
+    
+    // Compute moon age
+    double moonAge = MathOps::normalize( MathOps::TAU - (sun_eclipticLon - m_geocentric.getLongitude(RADS)), RADS );
+
+    // convert radians to Synodic day
+    m_age = SYNODIC_MONTH * (moonAge / MathOps::TAU);
+}
+
+/**
+ * Luna::computeHorizontal() - location stage of compute(): hour angle, horizontal
+ *                             coordinates and position angle of the bright limb
+ *
+ * @param _obs   - Observer carrying location and LST
+ */
+void Luna::computeHorizontal( Observer &_obs ) {
+    if (_obs.haveLocation()) {
+        m_horizontal = CoordOps::toHorizontal( _obs, m_equatorial );
+        computePositionAngle( CoordOps::toHorizontal( _obs, m_sunEquatorial) );
+        m_ha = MathOps::normalize(CoordOps::toHourAngle( _obs, m_equatorial ), RADS);
+        m_bHorizontal = true;
     }
+    else {
+        m_ha = 0.0;
+        m_horizontal[0] = 0.0;
+        m_horizontal[1] = 0.0;
+        m_posAngle = 0.0;
+        m_bHorizontal = false;
+    }
+}
+
+void Luna::computeHorizontal( const ObserverState& _state ) {
+    Body::computeHorizontal(_state);
+    if (m_bHorizontal)
+        computePositionAngle( CoordOps::toHorizontal( _state, m_sunEquatorial) );
+    else
+        m_posAngle = 0.0;
+}
+
+/**
+ * Luna::computePositionAngle() - position angle of the bright limb from the
+ *                                current horizontal coordinates
+ *
+ * @param _sunHorizontal - horizontal coordinates of the Sun
+ */
+void Luna::computePositionAngle( const Horizontal& _sunHorizontal ) {
+    double delta_az = m_horizontal.getAzimuth(RADS) - _sunHorizontal.getAzimuth(RADS);
+    m_posAngle = atan2( cos(_sunHorizontal.getAltitud(RADS)) * sin(delta_az),
+                       sin(_sunHorizontal.getAltitud(RADS)) * cos(m_horizontal.getAzimuth(RADS)) - cos(_sunHorizontal.getAltitud(RADS)) * sin(m_horizontal.getAzimuth(RADS)) * cos(delta_az));
 }
 
 double Luna::getPositionAngle(ANGLE_UNIT _type) const {
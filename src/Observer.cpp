@@ -3,10 +3,12 @@
 
 #include "hypatia/MathOps.h"
 #include "hypatia/CoordOps.h"
+#include "hypatia/ObserverState.h"
 
 #include "hypatia/models/VSOP87.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <math.h>
 
@@ -19,6 +21,8 @@ m_lst(0.0),
 m_tzOffsetST(0.0),
 m_tzOffsetDST(0.0),
 m_tzIndex(0),
+m_timeVersion(nextVersion()),
+m_locationVersion(nextVersion()),
 m_bLocation(false) {
 }
 
@@ -31,6 +35,8 @@ m_lst(0.0),
 m_tzOffsetST(0.0),
 m_tzOffsetDST(0.0),
 m_tzIndex(0),
+m_timeVersion(nextVersion()),
+m_locationVersion(nextVersion()),
 m_bLocation(false) {
     if ( _jd == 0 ) {
         setJD( TimeOps::now(UTC) );
@@ -50,6 +56,8 @@ m_lst(0.0),
 m_tzOffsetST(0.0),
 m_tzOffsetDST(0.0),
 m_tzIndex(0),
+m_timeVersion(nextVersion()),
+m_locationVersion(nextVersion()),
 m_bLocation(true) {
     if ( _jd == 0 ) {
         setJD( TimeOps::now(UTC) );
@@ -69,6 +77,8 @@ m_lst(0.0),
 m_tzOffsetST(0.0),
 m_tzOffsetDST(0.0),
 m_tzIndex(0),
+m_timeVersion(nextVersion()),
+m_locationVersion(nextVersion()),
 m_bLocation(true) {
     if ( _jd == 0 ) {
         setJD( TimeOps::now(UTC) );
@@ -91,10 +101,30 @@ void Observer::setSeconds(unsigned long _sec) {
 void Observer::setJD(double _jd) {
     if ( m_jd != _jd ) {
         m_jd = _jd;
-        update();
+        updateTime();
     }
 }
 
+void Observer::setEpoch(const EpochContext& _epoch) {
+    m_jd = _epoch.getJD();
+    m_jcentury = _epoch.getJC();
+    m_obliquity = _epoch.getObliquity();
+
+    if ( haveLocation() ) {
+        m_lst = _epoch.getLST(m_location.getLongitude(RADS));
+    }
+
+    m_heliocentricLoc = _epoch.getEarthHeliocentricVector(AU);
+    m_heliocentricVel = _epoch.getEarthHeliocentricVelocity(AU);
+    m_changed = false;
+    m_changedVel = false;
+
+    m_ascendant  = -1.0;
+    m_midheaven  = -1.0;
+    m_northNode  = -1.0;
+    m_timeVersion = nextVersion();
+}
+
 void Observer::setJDLocal(double _jd) {
     if ( !haveLocation() || m_tzIndex == 0 ) {
         setJD(_jd);
@@ -117,7 +147,7 @@ void Observer::setLocation(const Geodetic &_location) {
         m_location.getLatitude(RADS) != _location.getLatitude(RADS) ) {
         m_location = _location;
         m_bLocation = true;
-        update();
+        updateLocation();
     }
 }
 
@@ -127,7 +157,7 @@ void Observer::setLocation(double _lng_deg, double _lat_deg) {
         m_location.setLongitude(_lng_deg, DEGS);
         m_location.setLatitude(_lat_deg, DEGS);
         m_bLocation = true;
-        update();
+        updateLocation();
     }
 }
 
@@ -159,7 +189,7 @@ void Observer::setCityId(size_t _cityId) {
         m_location = GeoOps::getCityLocation(_cityId);
         setTimezoneIndex(GeoOps::getCityTimezoneIndex(_cityId));
         m_bLocation = true;
-        update();
+        updateLocation();
     }
 }
 
@@ -178,7 +208,24 @@ double Observer::getJDLocal() const {
     return m_jd + (GeoOps::tzIsDST(m_location.getLatitude(RADS), month, day)? m_tzOffsetDST : m_tzOffsetST);
 }
 
+/**
+ * nextVersion() - a new value for the time and location counters, unique among all observers
+ *                 so a Body computed for one observer is never taken as current for another
+ */
+unsigned long Observer::nextVersion() {
+    static std::atomic<unsigned long> version(0);
+    return ++version;
+}
+
 void Observer::update() {
+    updateTime();
+    updateLocation();
+}
+
+/**
+ * updateTime() - everything that depends on the JD
+ */
+void Observer::updateTime() {
     m_jcentury = TimeOps::toJC(m_jd);
     m_obliquity = CoordOps::meanObliquity(m_jcentury);
     
@@ -188,9 +235,25 @@ void Observer::update() {
     
     // Reset cached values
     m_changed = true; // force heliocentric location update
+    m_changedVel = true;
     m_ascendant  = -1.0;
     m_midheaven  = -1.0;
     m_northNode  = -1.0;
+    m_timeVersion = nextVersion();
+}
+
+/**
+ * updateLocation() - everything that depends on the location. Earth's heliocentric
+ *                    position doesn't, so it is kept
+ */
+void Observer::updateLocation() {
+    if ( haveLocation() ) {
+        m_lst = TimeOps::toLocalSideralTime(m_jd, m_location.getLongitude(RADS), RADS);
+    }
+
+    m_ascendant  = -1.0;
+    m_midheaven  = -1.0;
+    m_locationVersion = nextVersion();
 }
 
 Geodetic Observer::getLocation() const {
@@ -223,22 +286,36 @@ Vector3 Observer::getHeliocentricVector(DISTANCE_UNIT _type) {
     if (m_changed) {
         double pLng, pLat, pRad = 0.0;
         VSOP87::calcAllLocs(pLng, pLat, pRad, m_jcentury, EARTH);
-        m_heliocentricLoc = Ecliptic(pLng, pLat, pRad, RADS, AU).getVector(_type);
+        m_heliocentricLoc = Ecliptic(pLng, pLat, pRad, RADS, AU).getVector(AU);
         m_changed = false;
     }
     
-    return m_heliocentricLoc;
+    if (_type == AU) {
+        return m_heliocentricLoc;
+    }
+    return Ecliptic(m_heliocentricLoc, AU).getVector(_type);
+}
+
+// Only evaluated on request, most users never need Earth's velocity
+Vector3 Observer::getHeliocentricVelocity(DISTANCE_UNIT _type) {
+    if (m_changedVel) {
+        double pLng, pLat, pRad = 0.0;
+        double dLng, dLat, dRad = 0.0;
+        VSOP87::calcAllLocsAndRates(pLng, pLat, pRad, dLng, dLat, dRad, m_jcentury, EARTH);
+        m_heliocentricVel = CoordOps::toEclipticVelocity(Ecliptic(pLng, pLat, pRad, RADS, AU), dLng, dLat, dRad);
+        m_changedVel = false;
+    }
+
+    if (_type == AU) {
+        return m_heliocentricVel;
+    }
+    return Ecliptic(m_heliocentricVel, AU).getVector(_type);
 }
 
 // Formula from https://en.wikipedia.org/wiki/Ascendant#Calculation
 double Observer::getAscendant( ANGLE_UNIT _type ) {
     if ( haveLocation() &&m_ascendant == -1.0 ) {
-        double oL = getLST();
-        double e = getObliquity();
-        double lat = getLocation().getLatitude(RADS);
-        double y = cos(oL);
-        double x = -(sin(oL) * cos(e) + tan(lat) * sin(e));
-        m_ascendant = MathOps::normalize(atan2(y, x), RADS);
+        m_ascendant = ObserverState::toAscendant(getLST(), getObliquity(), getLocation().getLatitude(RADS));
     }
 
     return ( _type == RADS )? m_ascendant : MathOps::toDegrees(m_ascendant);
@@ -247,9 +324,7 @@ double Observer::getAscendant( ANGLE_UNIT _type ) {
 // Formula from https://en.wikipedia.org/wiki/Midheaven
 double Observer::getMidheaven( ANGLE_UNIT _type ) {
     if ( haveLocation() && m_midheaven == -1.0 ) {   
-        double oL = getLST();
-        double e = getObliquity();
-        m_midheaven = MathOps::normalize( atan2( sin(oL), cos(oL) * cos(e)), RADS);
+        m_midheaven = ObserverState::toMidheaven(getLST(), getObliquity());
     }
     return ( _type == RADS )? m_midheaven : MathOps::toDegrees(m_midheaven);
 }
@@ -257,172 +332,16 @@ double Observer::getMidheaven( ANGLE_UNIT _type ) {
 // Compute the true ecliptic longitude of the lunar ascending node in the requested unit.
 double Observer::getNorthNode( ANGLE_UNIT _type ) { 
     if ( m_northNode == -1.0 ) {
-        const double jd = getJD(); // Obtain the observer Julian day to anchor the node calculation.
-        const double jCentury = TimeOps::toJC(jd); // Convert the Julian day into Julian centuries referenced to J2000 using TimeOps utilities.
-        const double jCenturySq = jCentury * jCentury; // Precompute the squared Julian century term required by the polynomial model.
-        const double jCenturyCu = jCenturySq * jCentury; // Precompute the cubic Julian century term required by the polynomial model.
-        const double nodeLongitudeDeg = 125.04452 - 1934.136261 * jCentury + 0.0020708 * jCenturySq + jCenturyCu / 450000.0; // Evaluate the mean ecliptic longitude of the lunar ascending node in degrees (Meeus 1998, Ch. 47).
-        const double normalizedLongitudeDeg = MathOps::normalize(nodeLongitudeDeg, DEGS); // Normalize the mean longitude into the canonical 0-360 degree domain.
-        const double a1Deg = MathOps::normalize(119.75 + 131.849 * jCentury, DEGS); // Compute the first periodic argument used to correct the node to its true position.
-        const double a2Deg = MathOps::normalize(53.09 + 479264.29 * jCentury, DEGS); // Compute the second periodic argument used to correct the node to its true position.
-        const double nodeTrueDeg = normalizedLongitudeDeg + 0.0004664 * cos(MathOps::toRadians(a1Deg)) + 0.0000754 * cos(MathOps::toRadians(a2Deg)); // Apply the periodic terms that yield the true (osculating) node longitude.
-        m_northNode = MathOps::normalize(nodeTrueDeg, DEGS); // Normalize the corrected longitude back into the 0-360 degree range.
+        m_northNode = ObserverState::toNorthNode(getJD());
     }
     
     return ( _type == RADS )? MathOps::toRadians(m_northNode) : m_northNode;
 }
 
 std::array<double, 12> Observer::getHousesPlacidus(ANGLE_UNIT _type) {
-    std::array<double, 12> cusps{};
-
     if (!haveLocation()) {
-        return cusps;
-    }
-
-    const double ascActual = getAscendant(DEGS);
-    const double mcActual = getMidheaven(DEGS);
-    const double descActual = MathOps::normalize(ascActual + 180.0, DEGS);
-    const double icActual = MathOps::normalize(mcActual + 180.0, DEGS);
-
-    const double lstDeg = MathOps::normalize(MathOps::toDegrees(getLST()), DEGS);
-    const double obliquity = getObliquity();
-    const double latitude = getLocation().getLatitude(RADS);
-
-    const double sinE = sin(obliquity);
-    const double cosE = cos(obliquity);
-    const double tanPhi = tan(latitude);
-
-    auto toSignedDegrees = [](double degrees) {
-        double normalized = MathOps::normalize(degrees, DEGS);
-        if (normalized > 180.0) {
-            normalized -= 360.0;
-        }
-        return normalized;
-    };
-
-    auto clamp01 = [](double value, double minValue, double maxValue) {
-        return value < minValue ? minValue : (value > maxValue ? maxValue : value);
-    };
-
-    auto placidusEquation = [&](double eclipticLongitudeDeg, double target) {
-        double lambdaNorm = MathOps::normalize(eclipticLongitudeDeg, DEGS);
-        double lambdaRad = MathOps::toRadians(lambdaNorm);
-
-        double sinLambda = sin(lambdaRad);
-        double cosLambda = cos(lambdaRad);
-
-        double alpha = atan2(sinLambda * cosE, cosLambda);
-        double delta = asin(sinLambda * sinE);
-
-        double alphaDeg = MathOps::normalize(MathOps::toDegrees(alpha), DEGS);
-        double hourAngle = toSignedDegrees(lstDeg - alphaDeg);
-
-        double argument = -tanPhi * tan(delta);
-        argument = clamp01(argument, -1.0, 1.0);
-
-        double semiArc = MathOps::toDegrees(acos(argument));
-        return hourAngle - target * semiArc;
-    };
-
-    auto solveCusp = [&](double target, double seed) {
-        const double step = 0.5;
-        double candidate = MathOps::normalize(seed, DEGS);
-
-        auto scan = [&](double width) {
-            double start = seed - width * 0.5;
-            double prevLambda = start;
-            double prevValue = placidusEquation(prevLambda, target);
-            bool prevValid = std::isfinite(prevValue);
-
-            for (double offset = step; offset <= width; offset += step) {
-                double currentLambda = start + offset;
-                double currentValue = placidusEquation(currentLambda, target);
-                bool currentValid = std::isfinite(currentValue);
-
-                if (prevValid && currentValid && prevValue * currentValue <= 0.0) {
-                    double a = prevLambda;
-                    double b = currentLambda;
-                    double fa = prevValue;
-                    double fb = currentValue;
-
-                    for (int i = 0; i < 48; ++i) {
-                        double mid = 0.5 * (a + b);
-                        double fm = placidusEquation(mid, target);
-                        if (!std::isfinite(fm)) {
-                            break;
-                        }
-                        if (std::fabs(fm) < 1e-8) {
-                            a = b = mid;
-                            break;
-                        }
-                        if (fa * fm <= 0.0) {
-                            b = mid;
-                            fb = fm;
-                        } else {
-                            a = mid;
-                            fa = fm;
-                        }
-                    }
-
-                    candidate = MathOps::normalize(0.5 * (a + b), DEGS);
-                    return true;
-                }
-
-                prevLambda = currentLambda;
-                prevValue = currentValue;
-                prevValid = currentValid;
-            }
-            return false;
-        };
-
-        if (!scan(120.0)) {
-            scan(360.0);
-        }
-
-        return candidate;
-    };
-
-    auto normalizeDifference = [&](double from, double to) {
-        return MathOps::normalize(to - from, DEGS);
-    };
-
-    const double arcAscToMc = toSignedDegrees(mcActual - ascActual);
-    const double arcMcToDesc = toSignedDegrees(descActual - mcActual);
-
-    const double guessCusp12 = MathOps::normalize(ascActual + arcAscToMc * (2.0 / 3.0), DEGS);
-    const double guessCusp11 = MathOps::normalize(ascActual + arcAscToMc * (1.0 / 3.0), DEGS);
-    const double guessCusp9 = MathOps::normalize(mcActual + arcMcToDesc * (1.0 / 3.0), DEGS);
-    const double guessCusp8 = MathOps::normalize(mcActual + arcMcToDesc * (2.0 / 3.0), DEGS);
-
-    const double cusp12Actual = solveCusp(-2.0 / 3.0, guessCusp12);
-    const double cusp11Actual = solveCusp(-1.0 / 3.0, guessCusp11);
-    const double cusp9Actual = solveCusp(1.0 / 3.0, guessCusp9);
-    const double cusp8Actual = solveCusp(2.0 / 3.0, guessCusp8);
-
-    const double cusp2Actual = MathOps::normalize(cusp8Actual + 180.0, DEGS);
-    const double cusp3Actual = MathOps::normalize(cusp9Actual + 180.0, DEGS);
-    const double cusp5Actual = MathOps::normalize(cusp11Actual + 180.0, DEGS);
-    const double cusp6Actual = MathOps::normalize(cusp12Actual + 180.0, DEGS);
-
-    std::array<double, 12> absoluteCusps = {
-        ascActual,
-        cusp2Actual,
-        cusp3Actual,
-        icActual,
-        cusp5Actual,
-        cusp6Actual,
-        descActual,
-        cusp8Actual,
-        cusp9Actual,
-        mcActual,
-        cusp11Actual,
-        cusp12Actual
-    };
-
-    for (size_t i = 0; i < absoluteCusps.size(); ++i) {
-        double relativeDeg = normalizeDifference(ascActual, absoluteCusps[i]);
-        cusps[i] = (_type == RADS) ? MathOps::toRadians(relativeDeg) : relativeDeg;
+        return std::array<double, 12>{};
     }
 
-    return cusps;
+    return ObserverState::toHousesPlacidus(getAscendant(DEGS), getMidheaven(DEGS), getLST(), getObliquity(), getLocation().getLatitude(RADS), _type);
 }
\ No newline at end of file
@@ -0,0 +1,248 @@
+/*****************************************************************************\
+ * ObserverGroup.cpp
+ *
+ * Many observer locations sharing one epoch, with a batched conversion of
+ * equatorial positions to horizontal coordinates.
+ *
+\*****************************************************************************/
+
+#include "hypatia/ObserverGroup.h"
+
+#include "hypatia/MathOps.h"
+#include "hypatia/GeoOps.h"
+#include "hypatia/models/Exception.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <math.h>
+
+// observers handled per pass of the inner loops, small enough to stay on the stack
+static const size_t BLOCK = 256;
+
+// fewest (observer, position) pairs converted by a thread of their own
+static const size_t MIN_PER_THREAD = 16384;
+
+ObserverGroup::ObserverGroup() : m_jd(0.0), m_gmst(0.0), m_threads(1) {
+}
+
+ObserverGroup::ObserverGroup( const EpochContext& _epoch ) : m_jd(0.0), m_gmst(0.0), m_threads(1) {
+    setEpoch(_epoch);
+}
+
+ObserverGroup::~ObserverGroup() {
+}
+
+/**
+ * add() - add an observer
+ *
+ * @param _lng_deg - longitude (degrees)
+ * @param _lat_deg - latitude (degrees)
+ */
+void ObserverGroup::add( double _lng_deg, double _lat_deg ) {
+    double lng = MathOps::toRadians(_lng_deg);
+    double lat = MathOps::toRadians(_lat_deg);
+    m_lng.push_back(lng);
+    m_lat.push_back(lat);
+    m_sinLat.push_back(sin(lat));
+    m_cosLat.push_back(cos(lat));
+
+    // same as EpochContext::getLST()
+    double lst = m_gmst + lng;
+    m_lst.push_back(lst);
+    m_sinLst.push_back(sin(lst));
+    m_cosLst.push_back(cos(lst));
+}
+
+void ObserverGroup::add( const Geodetic& _location ) {
+    add( _location.getLongitude(DEGS), _location.getLatitude(DEGS) );
+}
+
+/**
+ * addCity() - add an observer at the location of one of GeoOps cities
+ *
+ * @param _cityId - city index
+ */
+void ObserverGroup::addCity( size_t _cityId ) {
+    add( GeoOps::getCityLongitude(_cityId), GeoOps::getCityLatitude(_cityId) );
+}
+
+void ObserverGroup::reserve( size_t _total ) {
+    m_lng.reserve(_total);
+    m_lat.reserve(_total);
+    m_sinLat.reserve(_total);
+    m_cosLat.reserve(_total);
+    m_lst.reserve(_total);
+    m_sinLst.reserve(_total);
+    m_cosLst.reserve(_total);
+}
+
+void ObserverGroup::clear() {
+    m_lng.clear();
+    m_lat.clear();
+    m_sinLat.clear();
+    m_cosLat.clear();
+    m_lst.clear();
+    m_sinLst.clear();
+    m_cosLst.clear();
+}
+
+double ObserverGroup::getLongitude( size_t _index, ANGLE_UNIT _type ) const {
+    if (_type == DEGS)
+        return MathOps::toDegrees(m_lng[_index]);
+    return m_lng[_index];
+}
+
+double ObserverGroup::getLatitude( size_t _index, ANGLE_UNIT _type ) const {
+    if (_type == DEGS)
+        return MathOps::toDegrees(m_lat[_index]);
+    return m_lat[_index];
+}
+
+double ObserverGroup::getLST( size_t _index, ANGLE_UNIT _type ) const {
+    if (_type == DEGS)
+        return MathOps::toDegrees(m_lst[_index]);
+    return m_lst[_index];
+}
+
+/**
+ * setEpoch() - local sidereal time of every observer at the epoch of a context
+ *
+ * @param _epoch - context of the epoch
+ */
+void ObserverGroup::setEpoch( const EpochContext& _epoch ) {
+    m_jd = _epoch.getJD();
+    m_gmst = _epoch.getGMST(RADS);
+
+    for (size_t i = 0; i < m_lng.size(); i++) {
+        double lst = _epoch.getLST(m_lng[i]);
+        m_lst[i] = lst;
+        m_sinLst[i] = sin(lst);
+        m_cosLst[i] = cos(lst);
+    }
+}
+
+/**
+ * toHorizontal() - equatorial positions to horizontal coordinates for every observer
+ *
+ * Same as CoordOps::toHorizontal(Observer, Equatorial) per observer and position
+ * (up to rounding). Observers are split in contiguous ranges among the worker
+ * threads, each writing its own part of the output rows.
+ *
+ * @param _equatorials - positions
+ * @param _count - number of positions
+ * @param _alt - output, _count * size() altitudes (radians)
+ * @param _az - output, _count * size() azimuths (radians)
+ * @param _ha - optional output, _count * size() hour angles (radians)
+ */
+void ObserverGroup::toHorizontal( const Equatorial* _equatorials, size_t _count, double* _alt, double* _az, double* _ha ) const {
+    const size_t total = size();
+    if (total == 0 || _count == 0)
+        return;
+
+    // threads split the observers, each converting all the positions
+    hypatia::forEachRange(total, m_threads, MIN_PER_THREAD / _count, [=](size_t _begin, size_t _end) {
+        toHorizontalRange(_equatorials, _count, _begin, _end, _alt, _az, _ha);
+    });
+}
+
+void ObserverGroup::toHorizontal( const Equatorial& _equatorial, std::vector<double>& _alt, std::vector<double>& _az ) const {
+    _alt.resize(size());
+    _az.resize(size());
+    toHorizontal(&_equatorial, 1, _alt.data(), _az.data());
+}
+
+void ObserverGroup::toHorizontal( const std::vector<Equatorial>& _equatorials, std::vector<double>& _alt, std::vector<double>& _az ) const {
+    _alt.resize(_equatorials.size() * size());
+    _az.resize(_equatorials.size() * size());
+    toHorizontal(_equatorials.data(), _equatorials.size(), _alt.data(), _az.data());
+}
+
+/**
+ * toHorizontal() - every body of a snapshot to horizontal coordinates for every observer
+ *
+ * @param _snapshot - computed at the same epoch as the group
+ * @param _alt - output, SolarSystemSnapshot::TOTAL rows of size() altitudes (radians)
+ * @param _az - output, SolarSystemSnapshot::TOTAL rows of size() azimuths (radians)
+ *
+ * @throws Exception if the snapshot is not at the epoch of the group
+ */
+void ObserverGroup::toHorizontal( const SolarSystemSnapshot& _snapshot, std::vector<double>& _alt, std::vector<double>& _az ) const {
+    if (_snapshot.getJD() != m_jd)
+        throw Exception("Snapshot and observer group are at different epochs");
+
+    std::vector<Equatorial> equatorials;
+    equatorials.reserve(SolarSystemSnapshot::TOTAL);
+    for (int i = SUN; i <= LUNA; i++)
+        equatorials.push_back( _snapshot.getEquatorial( BodyId(i) ) );
+
+    toHorizontal(equatorials, _alt, _az);
+}
+
+/**
+ * toHorizontalRange() - horizontal coordinates for the observers [_begin, _end)
+ *
+ * The trigonometry of each position is done once and the hour angle comes from
+ * the angle difference identities over the cached sin/cos of the sidereal times,
+ * so the first pass over a block is plain arithmetic on contiguous arrays the
+ * compiler vectorizes. Only asin() and atan2() are left per observer.
+ *
+ * Azimuth is measured from North through East like CoordOps::toHorizontal(),
+ * but with atan2() instead of acos(), so it stays defined at the poles.
+ */
+void ObserverGroup::toHorizontalRange(  const Equatorial* _equatorials, size_t _count,
+                                        size_t _begin, size_t _end,
+                                        double* _alt, double* _az, double* _ha ) const {
+    const size_t total = size();
+    const double* sinLat = m_sinLat.data();
+    const double* cosLat = m_cosLat.data();
+    const double* sinLst = m_sinLst.data();
+    const double* cosLst = m_cosLst.data();
+    const double* lst = m_lst.data();
+
+    double sinAlt[BLOCK];
+    double north[BLOCK];
+    double east[BLOCK];
+
+    for (size_t p = 0; p < _count; p++) {
+        const double ra = _equatorials[p].getRightAscension(RADS);
+        const double dec = _equatorials[p].getDeclination(RADS);
+        const double sra = sin(ra);
+        const double cra = cos(ra);
+        const double sd = sin(dec);
+        const double cd = cos(dec);
+
+        double* alt = _alt + p * total;
+        double* az = _az + p * total;
+
+        for (size_t begin = _begin; begin < _end; begin += BLOCK) {
+            const size_t n = std::min(BLOCK, _end - begin);
+            const double* sl = sinLat + begin;
+            const double* cl = cosLat + begin;
+            const double* st = sinLst + begin;
+            const double* ct = cosLst + begin;
+
+            for (size_t i = 0; i < n; i++) {
+                // ha = lst - ra
+                double cosH = ct[i] * cra + st[i] * sra;
+                double sinH = st[i] * cra - ct[i] * sra;
+
+                sinAlt[i] = sd * sl[i] + cd * cl[i] * cosH;
+                north[i] = sd * cl[i] - cd * sl[i] * cosH;
+                east[i] = -cd * sinH;
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                double a = atan2(east[i], north[i]);
+                alt[begin + i] = asin( std::max(-1.0, std::min(1.0, sinAlt[i])) );
+                az[begin + i] = (a < 0.0) ? a + MathOps::TAU : a;
+            }
+
+            if (_ha) {
+                double* ha = _ha + p * total;
+                for (size_t i = 0; i < n; i++)
+                    ha[begin + i] = MathOps::normalize(lst[begin + i] - ra, RADS);
+            }
+        }
+    }
+}
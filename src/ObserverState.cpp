@@ -0,0 +1,358 @@
+/*****************************************************************************\
+ * ObserverState.cpp
+ *
+ * Immutable snapshot of an Observer, safe to share between threads.
+ *
+\*****************************************************************************/
+
+#include "hypatia/ObserverState.h"
+
+#include "hypatia/CoordOps.h"
+#include "hypatia/models/VSOP87.h"
+
+#include <algorithm>
+#include <math.h>
+
+ObserverState::ObserverState() :
+m_jd(0.0),
+m_jcentury(0.0),
+m_obliquity(0.0),
+m_lst(0.0),
+m_ascendant(-1.0),
+m_midheaven(-1.0),
+m_northNode(-1.0),
+m_timeVersion(Observer::nextVersion()),
+m_locationVersion(Observer::nextVersion()),
+m_bLocation(false) {
+}
+
+/**
+ * ObserverState() - evaluate everything an Observer computes lazily
+ *
+ * Each quantity matches, bit for bit, what the Observer returns.
+ *
+ * @param _obs - Observer
+ */
+ObserverState::ObserverState( const Observer& _obs ) {
+    init(_obs);
+
+    double lng, lat, rad;
+    double dLng, dLat, dRad;
+    VSOP87::calcAllLocsAndRates(lng, lat, rad, dLng, dLat, dRad, m_jcentury, EARTH);
+    m_earth = Ecliptic(lng, lat, rad, RADS, AU);
+    m_earthVector = m_earth.getVector(AU);
+    m_earthVelocity = CoordOps::toEclipticVelocity(m_earth, dLng, dLat, dRad);
+}
+
+/**
+ * ObserverState() - same as ObserverState( _obs ) with Earth's position from a shared
+ *                   context, evaluated again only if the context is for another JD
+ *
+ * @param _obs - Observer
+ * @param _epoch - context computed at the observer's JD
+ */
+ObserverState::ObserverState( const Observer& _obs, const EpochContext& _epoch ) {
+    if ( _epoch.getJD() != _obs.getJD() ) {
+        *this = ObserverState(_obs);
+        return;
+    }
+
+    init(_obs);
+    m_earth = _epoch.getEarthHeliocentric();
+    m_earthVector = _epoch.getEarthHeliocentricVector(AU);
+    m_earthVelocity = _epoch.getEarthHeliocentricVelocity(AU);
+}
+
+ObserverState::~ObserverState() {
+}
+
+/**
+ * init() - everything but Earth's position
+ *
+ * @param _obs - Observer
+ */
+void ObserverState::init( const Observer& _obs ) {
+    m_location = _obs.getLocation();
+    m_bLocation = _obs.haveLocation();
+    m_jd = _obs.getJD();
+    m_jcentury = _obs.getJC();
+    m_obliquity = _obs.getObliquity();
+    m_lst = _obs.getLST(RADS);
+    m_timeVersion = _obs.getTimeVersion();
+    m_locationVersion = _obs.getLocationVersion();
+
+    m_ascendant = -1.0;
+    m_midheaven = -1.0;
+    if ( m_bLocation ) {
+        m_ascendant = toAscendant(m_lst, m_obliquity, m_location.getLatitude(RADS));
+        m_midheaven = toMidheaven(m_lst, m_obliquity);
+    }
+    m_northNode = toNorthNode(m_jd);
+}
+
+Geodetic ObserverState::getLocation() const {
+    if ( haveLocation() ) {
+        return m_location;
+    }
+    else {
+        return Geodetic();
+    }
+}
+
+double ObserverState::getLST( ANGLE_UNIT _type ) const {
+    if ( haveLocation() ) {
+        if (_type == RADS) {
+            return m_lst;
+        } else {
+            return MathOps::toDegrees(m_lst);
+        }
+    }
+    else {
+        return 0.0;
+    }
+}
+
+Vector3 ObserverState::getHeliocentricVector( DISTANCE_UNIT _type ) const {
+    if (_type == AU) {
+        return m_earthVector;
+    }
+    return Ecliptic(m_earthVector, AU).getVector(_type);
+}
+
+Vector3 ObserverState::getHeliocentricVelocity( DISTANCE_UNIT _type ) const {
+    if (_type == AU) {
+        return m_earthVelocity;
+    }
+    return Ecliptic(m_earthVelocity, AU).getVector(_type);
+}
+
+double ObserverState::getAscendant( ANGLE_UNIT _type ) const {
+    return ( _type == RADS )? m_ascendant : MathOps::toDegrees(m_ascendant);
+}
+
+double ObserverState::getMidheaven( ANGLE_UNIT _type ) const {
+    return ( _type == RADS )? m_midheaven : MathOps::toDegrees(m_midheaven);
+}
+
+double ObserverState::getNorthNode( ANGLE_UNIT _type ) const {
+    return ( _type == RADS )? MathOps::toRadians(m_northNode) : m_northNode;
+}
+
+std::array<double, 12> ObserverState::getHousesPlacidus( ANGLE_UNIT _type ) const {
+    if ( !haveLocation() ) {
+        return std::array<double, 12>{};
+    }
+
+    return toHousesPlacidus(getAscendant(DEGS), getMidheaven(DEGS), m_lst, m_obliquity, m_location.getLatitude(RADS), _type);
+}
+
+/**
+ * toAscendant() - ecliptic longitude rising on the eastern horizon
+ *                 Formula from https://en.wikipedia.org/wiki/Ascendant#Calculation
+ *
+ * @param _lst - local sidereal time (radians)
+ * @param _obliquity - obliquity of the ecliptic (radians)
+ * @param _lat - latitude (radians)
+ *
+ * @return ascendant (radians)
+ */
+double ObserverState::toAscendant( double _lst, double _obliquity, double _lat ) {
+    double y = cos(_lst);
+    double x = -(sin(_lst) * cos(_obliquity) + tan(_lat) * sin(_obliquity));
+    return MathOps::normalize(atan2(y, x), RADS);
+}
+
+/**
+ * toMidheaven() - ecliptic longitude culminating on the meridian
+ *                 Formula from https://en.wikipedia.org/wiki/Midheaven
+ *
+ * @param _lst - local sidereal time (radians)
+ * @param _obliquity - obliquity of the ecliptic (radians)
+ *
+ * @return midheaven (radians)
+ */
+double ObserverState::toMidheaven( double _lst, double _obliquity ) {
+    return MathOps::normalize( atan2( sin(_lst), cos(_lst) * cos(_obliquity)), RADS);
+}
+
+/**
+ * toNorthNode() - true ecliptic longitude of the lunar ascending node
+ *
+ * @param _jd - julian day
+ *
+ * @return longitude (degrees)
+ */
+double ObserverState::toNorthNode( double _jd ) {
+    const double jCentury = TimeOps::toJC(_jd); // Convert the Julian day into Julian centuries referenced to J2000 using TimeOps utilities.
+    const double jCenturySq = jCentury * jCentury; // Precompute the squared Julian century term required by the polynomial model.
+    const double jCenturyCu = jCenturySq * jCentury; // Precompute the cubic Julian century term required by the polynomial model.
+    const double nodeLongitudeDeg = 125.04452 - 1934.136261 * jCentury + 0.0020708 * jCenturySq + jCenturyCu / 450000.0; // Evaluate the mean ecliptic longitude of the lunar ascending node in degrees (Meeus 1998, Ch. 47).
+    const double normalizedLongitudeDeg = MathOps::normalize(nodeLongitudeDeg, DEGS); // Normalize the mean longitude into the canonical 0-360 degree domain.
+    const double a1Deg = MathOps::normalize(119.75 + 131.849 * jCentury, DEGS); // Compute the first periodic argument used to correct the node to its true position.
+    const double a2Deg = MathOps::normalize(53.09 + 479264.29 * jCentury, DEGS); // Compute the second periodic argument used to correct the node to its true position.
+    const double nodeTrueDeg = normalizedLongitudeDeg + 0.0004664 * cos(MathOps::toRadians(a1Deg)) + 0.0000754 * cos(MathOps::toRadians(a2Deg)); // Apply the periodic terms that yield the true (osculating) node longitude.
+    return MathOps::normalize(nodeTrueDeg, DEGS); // Normalize the corrected longitude back into the 0-360 degree range.
+}
+
+/**
+ * toHousesPlacidus() - cusps of the twelve Placidus houses
+ *
+ * @param _ascendant_deg - ascendant (degrees)
+ * @param _midheaven_deg - midheaven (degrees)
+ * @param _lst - local sidereal time (radians)
+ * @param _obliquity - obliquity of the ecliptic (radians)
+ * @param _lat - latitude (radians)
+ * @param _type - unit of the result
+ *
+ * @return cusps relative to the ascendant
+ */
+std::array<double, 12> ObserverState::toHousesPlacidus( double _ascendant_deg, double _midheaven_deg,
+                                                        double _lst, double _obliquity, double _lat,
+                                                        ANGLE_UNIT _type ) {
+    std::array<double, 12> cusps{};
+
+    const double ascActual = _ascendant_deg;
+    const double mcActual = _midheaven_deg;
+    const double descActual = MathOps::normalize(ascActual + 180.0, DEGS);
+    const double icActual = MathOps::normalize(mcActual + 180.0, DEGS);
+
+    const double lstDeg = MathOps::normalize(MathOps::toDegrees(_lst), DEGS);
+    const double obliquity = _obliquity;
+    const double latitude = _lat;
+
+    const double sinE = sin(obliquity);
+    const double cosE = cos(obliquity);
+    const double tanPhi = tan(latitude);
+
+    auto toSignedDegrees = [](double degrees) {
+        double normalized = MathOps::normalize(degrees, DEGS);
+        if (normalized > 180.0) {
+            normalized -= 360.0;
+        }
+        return normalized;
+    };
+
+    auto clamp01 = [](double value, double minValue, double maxValue) {
+        return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+    };
+
+    auto placidusEquation = [&](double eclipticLongitudeDeg, double target) {
+        double lambdaNorm = MathOps::normalize(eclipticLongitudeDeg, DEGS);
+        double lambdaRad = MathOps::toRadians(lambdaNorm);
+
+        double sinLambda = sin(lambdaRad);
+        double cosLambda = cos(lambdaRad);
+
+        double alpha = atan2(sinLambda * cosE, cosLambda);
+        double delta = asin(sinLambda * sinE);
+
+        double alphaDeg = MathOps::normalize(MathOps::toDegrees(alpha), DEGS);
+        double hourAngle = toSignedDegrees(lstDeg - alphaDeg);
+
+        double argument = -tanPhi * tan(delta);
+        argument = clamp01(argument, -1.0, 1.0);
+
+        double semiArc = MathOps::toDegrees(acos(argument));
+        return hourAngle - target * semiArc;
+    };
+
+    auto solveCusp = [&](double target, double seed) {
+        const double step = 0.5;
+        double candidate = MathOps::normalize(seed, DEGS);
+
+        auto scan = [&](double width) {
+            double start = seed - width * 0.5;
+            double prevLambda = start;
+            double prevValue = placidusEquation(prevLambda, target);
+            bool prevValid = std::isfinite(prevValue);
+
+            for (double offset = step; offset <= width; offset += step) {
+                double currentLambda = start + offset;
+                double currentValue = placidusEquation(currentLambda, target);
+                bool currentValid = std::isfinite(currentValue);
+
+                if (prevValid && currentValid && prevValue * currentValue <= 0.0) {
+                    double a = prevLambda;
+                    double b = currentLambda;
+                    double fa = prevValue;
+
+                    for (int i = 0; i < 48; ++i) {
+                        double mid = 0.5 * (a + b);
+                        double fm = placidusEquation(mid, target);
+                        if (!std::isfinite(fm)) {
+                            break;
+                        }
+                        if (std::fabs(fm) < 1e-8) {
+                            a = b = mid;
+                            break;
+                        }
+                        if (fa * fm <= 0.0) {
+                            b = mid;
+                        } else {
+                            a = mid;
+                            fa = fm;
+                        }
+                    }
+
+                    candidate = MathOps::normalize(0.5 * (a + b), DEGS);
+                    return true;
+                }
+
+                prevLambda = currentLambda;
+                prevValue = currentValue;
+                prevValid = currentValid;
+            }
+            return false;
+        };
+
+        if (!scan(120.0)) {
+            scan(360.0);
+        }
+
+        return candidate;
+    };
+
+    auto normalizeDifference = [&](double from, double to) {
+        return MathOps::normalize(to - from, DEGS);
+    };
+
+    const double arcAscToMc = toSignedDegrees(mcActual - ascActual);
+    const double arcMcToDesc = toSignedDegrees(descActual - mcActual);
+
+    const double guessCusp12 = MathOps::normalize(ascActual + arcAscToMc * (2.0 / 3.0), DEGS);
+    const double guessCusp11 = MathOps::normalize(ascActual + arcAscToMc * (1.0 / 3.0), DEGS);
+    const double guessCusp9 = MathOps::normalize(mcActual + arcMcToDesc * (1.0 / 3.0), DEGS);
+    const double guessCusp8 = MathOps::normalize(mcActual + arcMcToDesc * (2.0 / 3.0), DEGS);
+
+    const double cusp12Actual = solveCusp(-2.0 / 3.0, guessCusp12);
+    const double cusp11Actual = solveCusp(-1.0 / 3.0, guessCusp11);
+    const double cusp9Actual = solveCusp(1.0 / 3.0, guessCusp9);
+    const double cusp8Actual = solveCusp(2.0 / 3.0, guessCusp8);
+
+    const double cusp2Actual = MathOps::normalize(cusp8Actual + 180.0, DEGS);
+    const double cusp3Actual = MathOps::normalize(cusp9Actual + 180.0, DEGS);
+    const double cusp5Actual = MathOps::normalize(cusp11Actual + 180.0, DEGS);
+    const double cusp6Actual = MathOps::normalize(cusp12Actual + 180.0, DEGS);
+
+    std::array<double, 12> absoluteCusps = {
+        ascActual,
+        cusp2Actual,
+        cusp3Actual,
+        icActual,
+        cusp5Actual,
+        cusp6Actual,
+        descActual,
+        cusp8Actual,
+        cusp9Actual,
+        mcActual,
+        cusp11Actual,
+        cusp12Actual
+    };
+
+    for (size_t i = 0; i < absoluteCusps.size(); ++i) {
+        double relativeDeg = normalizeDifference(ascActual, absoluteCusps[i]);
+        cusps[i] = (_type == RADS) ? MathOps::toRadians(relativeDeg) : relativeDeg;
+    }
+
+    return cusps;
+}
@@ -0,0 +1,58 @@
+/*****************************************************************************\
+ * Parallel.h
+ *
+ * Internal helper splitting a loop over contiguous ranges of items among
+ * std::threads, shared by the batch calls (Constellation::classify(),
+ * ObserverGroup::toHorizontal(), EventOps::findEvents()). Not installed.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace hypatia {
+
+/**
+ * forEachRange() - run _task( begin, end ) over contiguous ranges of _count items
+ *
+ * The calling thread runs the first range and joins the others before returning.
+ *
+ * @param _count - number of items
+ * @param _threads - threads to use, 0 for std::thread::hardware_concurrency()
+ * @param _minPerThread - fewest items worth a thread of their own, below it
+ *                        the threads cost more than they save
+ * @param _task - callable taking ( size_t begin, size_t end )
+ */
+template<class F>
+void forEachRange( size_t _count, unsigned _threads, size_t _minPerThread, F _task ) {
+    if (_count == 0)
+        return;
+
+    if (_threads == 0)
+        _threads = std::thread::hardware_concurrency();
+
+    size_t maxThreads = _count / std::max(_minPerThread, (size_t)1);
+    if (maxThreads < _threads)
+        _threads = (unsigned)maxThreads;
+
+    if (_threads <= 1) {
+        _task((size_t)0, _count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(_threads - 1);
+
+    size_t step = (_count + _threads - 1) / _threads;
+    for (size_t begin = step; begin < _count; begin += step)
+        workers.push_back( std::thread(_task, begin, std::min(begin + step, _count)) );
+    _task((size_t)0, std::min(step, _count));
+
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+}
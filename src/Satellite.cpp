@@ -6,6 +6,9 @@
 
 #include "hypatia/Satellite.h"
 #include "hypatia/CoordOps.h"
+#include "hypatia/models/VSOP87.h"
+
+#include <vector>
 
 Satellite::Satellite(): m_name("NAN") {
     m_bodyId = SATELLITE;
@@ -21,6 +24,7 @@ Satellite::~Satellite() {
 
 void Satellite::setTLE(const TLE& _tle) {
     m_sgp4.setTLE(_tle);
+    m_timeVersion = 0;
     
     m_name = _tle.getName();
 }
@@ -38,25 +42,105 @@ double Satellite::getPeriod(TIME_UNIT _unit) const {
 }
 
 void Satellite::compute(Observer &_obs) {
-    if (m_jcentury != _obs.getJC()) {
-        m_jcentury = _obs.getJC();
-        
+    if (syncTime(_obs)) {
         m_eci = m_sgp4.getECI(_obs.getJD());
         
         m_geocentric = CoordOps::toGeocentric(_obs, m_eci);
         m_heliocentric = CoordOps::toHeliocentric(_obs, m_geocentric);
         m_equatorial = Equatorial(m_eci.getPosition(AU));
-        
-        if ( _obs.haveLocation() ) {
-            m_ha = MathOps::normalize(CoordOps::toHourAngle( _obs, m_equatorial ), RADS);
-            m_horizontal = CoordOps::toHorizontal( _obs, m_equatorial );
-            m_bHorizontal = true;
-        }
-        else {
-            m_ha = 0.0;
-            m_horizontal[0] = 0.0;
-            m_horizontal[1] = 0.0;
-            m_bHorizontal = false;
-        }
     }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+void Satellite::compute(Observer &_obs, const EpochContext& _epoch) {
+    if (_epoch.getJD() != _obs.getJD()) {
+        compute(_obs);
+        return;
+    }
+
+    if (syncTime(_obs)) {
+        m_eci = m_sgp4.getECI(_obs.getJD());
+
+        m_equatorial = Equatorial(m_eci.getPosition(AU));
+        m_geocentric = CoordOps::toGeocentric(_epoch.getObliquity(), m_equatorial.getRightAscension(RADS), m_equatorial.getDeclination(RADS), m_eci.getPosition(AU).getMagnitud());
+        m_heliocentric = CoordOps::toHeliocentric(_epoch, m_geocentric);
+    }
+
+    if (syncLocation(_obs))
+        computeHorizontal(_obs);
+}
+
+void Satellite::compute(const ObserverState& _state) {
+    if (syncTime(_state)) {
+        m_eci = m_sgp4.getECI(_state.getJD());
+
+        m_geocentric = CoordOps::toGeocentric(_state, m_eci);
+        m_heliocentric = CoordOps::toHeliocentric(_state, m_geocentric);
+        m_equatorial = Equatorial(m_eci.getPosition(AU));
+    }
+
+    if (syncLocation(_state))
+        computeHorizontal(_state);
+}
+
+/**
+ * Satellite::computeRange() - positions at evenly spaced times
+ *
+ * @param _obs     - location of the observer (its JD is not used)
+ * @param _jdStart - first julian day
+ * @param _jdEnd   - last julian day
+ * @param _step    - days between samples
+ * @param _out     - room for getRangeSize( _jdStart, _jdEnd, _step ) samples
+ *
+ * @return number of samples written
+ */
+size_t Satellite::computeRange( const Observer& _obs, double _jdStart, double _jdEnd, double _step, Sample* _out ) const {
+    const size_t n = getRangeSize(_jdStart, _jdEnd, _step);
+
+    std::vector<double> jds(n);
+    for (size_t k = 0; k < n; k++)
+        jds[k] = _jdStart + k * _step;
+
+    return computeRange(_obs, jds.data(), n, _out);
+}
+
+/**
+ * Satellite::computeRange() - positions at explicit times
+ *
+ * Same as compute() at each of the julian days: SGP4 gives the geocentric
+ * equatorial position, which the horizontal coordinates are taken from as
+ * for any other body. The satellite's own state is not touched.
+ *
+ * @param _obs   - location of the observer (its JD is not used)
+ * @param _jds   - julian days
+ * @param _count - number of julian days
+ * @param _out   - room for _count samples
+ *
+ * @return number of samples written
+ */
+size_t Satellite::computeRange( const Observer& _obs, const double* _jds, size_t _count, Sample* _out ) const {
+    if (_count == 0)
+        return 0;
+
+    std::vector<double> earth(3 * _count);
+    std::vector<double> loc(3 * _count);
+
+    for (size_t k = 0; k < _count; k++) {
+        const double jc = TimeOps::toJC(_jds[k]);
+        _out[k].jd = _jds[k];
+
+        VSOP87::calcAllLocs(earth[3 * k], earth[3 * k + 1], earth[3 * k + 2], jc, EARTH);
+
+        Vector3 position = m_sgp4.getECI(_jds[k]).getPosition(AU);
+        Equatorial equatorial = Equatorial(position);
+        Ecliptic geo = CoordOps::toGeocentric(CoordOps::meanObliquity(jc), equatorial.getRightAscension(RADS), equatorial.getDeclination(RADS), position.getMagnitud());
+        loc[3 * k] = geo.getLongitude(RADS);
+        loc[3 * k + 1] = geo.getLatitude(RADS);
+        loc[3 * k + 2] = geo.getRadius(AU);
+    }
+
+    rangeSamples(SATELLITE, _obs, loc.data(), earth.data(), _count, _out);
+    return _count;
 }
@@ -0,0 +1,159 @@
+/*****************************************************************************\
+ * SolarSystemSnapshot.cpp
+ *
+ * Positions of the Sun, planets, Pluto and Luna at one epoch, computed in a
+ * single pass.
+ *
+\*****************************************************************************/
+
+#include "hypatia/SolarSystemSnapshot.h"
+
+#include "hypatia/CoordOps.h"
+#include "hypatia/TimeOps.h"
+
+#include "hypatia/Luna.h"
+#include "hypatia/models/Pluto.h"
+#include "hypatia/models/VSOP87.h"
+
+#include <string.h>
+
+const int SolarSystemSnapshot::TOTAL = LUNA + 1;
+
+SolarSystemSnapshot::SolarSystemSnapshot() {
+    memset(m_table, 0, sizeof(m_table));
+}
+
+SolarSystemSnapshot::SolarSystemSnapshot( double _jd ) {
+    memset(m_table, 0, sizeof(m_table));
+    compute(_jd);
+}
+
+SolarSystemSnapshot::SolarSystemSnapshot( const EpochContext& _epoch ) {
+    memset(m_table, 0, sizeof(m_table));
+    compute(_epoch);
+}
+
+SolarSystemSnapshot::~SolarSystemSnapshot() {
+}
+
+/**
+ * compute() - evaluate every body of the solar system at the given julian day
+ *
+ * @param _jd - julian day
+ */
+void SolarSystemSnapshot::compute( double _jd ) {
+    compute( EpochContext(_jd) );
+}
+
+/**
+ * compute() - evaluate every body of the solar system at the epoch of a context
+ *
+ * The quantities every Body::compute() would otherwise recompute on its own
+ * come from the context and are shared:
+ *   - the powers of t used by all the VSOP87 series
+ *   - Earth's heliocentric position and velocity (used by the Sun and every geocentric conversion)
+ *   - the mean obliquity of the ecliptic
+ *   - the nutation in longitude and obliquity (stored, not applied, as in Body)
+ *
+ * The table follows Body::compute() conventions: EARTH has a null geocentric
+ * position, the SUN is Earth's heliocentric position rotated 180 degrees and
+ * equatorial coordinates are of the mean equinox of date.
+ *
+ * @param _epoch - context of the epoch
+ */
+void SolarSystemSnapshot::compute( const EpochContext& _epoch ) {
+    m_epoch = _epoch;
+
+    const double jcentury = m_epoch.getJC();
+    const double obliquity = m_epoch.getObliquity();
+    const double* tPowers = m_epoch.getPowers();
+    const Vector3 earthVector = m_epoch.getEarthHeliocentricVector(AU);
+    const Vector3 earthVelocity = m_epoch.getEarthHeliocentricVelocity(AU);
+
+    // Earth first, everything geocentric depends on it
+    Entry& earth = m_table[EARTH];
+    Ecliptic earthLoc = m_epoch.getEarthHeliocentric();
+    earth.hLng = earthLoc.getLongitude(RADS);
+    earth.hLat = earthLoc.getLatitude(RADS);
+    earth.hRad = earthLoc.getRadius(AU);
+    double dLng, dLat, dRad;
+
+    for (int i = SUN; i < TOTAL; i++) {
+        Entry& e = m_table[i];
+        BodyId id = BodyId(i);
+        Vector3 velocity;
+
+        if (id == EARTH) {
+            e.gLng = e.gLat = e.gRad = 0.0;
+            velocity = Vector3(0., 0., 0.);
+        }
+        else if (id == SUN) {
+            e.hLng = earth.hLng;
+            e.hLat = earth.hLat;
+            e.hRad = earth.hRad;
+            e.gLng = earth.hLng + MathOps::PI;
+            e.gLat = earth.hLat * -1.;
+            e.gRad = earth.hRad;
+            velocity = earthVelocity * -1.;
+        }
+        else if (id == LUNA) {
+            Ecliptic geo = Luna::computeGeocentric(jcentury, velocity);
+            Ecliptic helio = Ecliptic(earthVector + geo.getVector(AU), AU);
+            e.gLng = geo.getLongitude(RADS);
+            e.gLat = geo.getLatitude(RADS);
+            e.gRad = geo.getRadius(AU);
+            e.hLng = helio.getLongitude(RADS);
+            e.hLat = helio.getLatitude(RADS);
+            e.hRad = helio.getRadius(AU);
+        }
+        else {
+            if (id == PLUTO)
+                Pluto::calcAllLocsAndRates(e.hLng, e.hLat, e.hRad, dLng, dLat, dRad, jcentury);
+            else
+                VSOP87::calcAllLocsAndRatesSIMD(e.hLng, e.hLat, e.hRad, dLng, dLat, dRad, tPowers, id);
+
+            Ecliptic helio = Ecliptic(e.hLng, e.hLat, e.hRad, RADS, AU);
+            Ecliptic geo = Ecliptic(helio.getVector(AU) - earthVector, AU);
+            velocity = CoordOps::toEclipticVelocity(helio, dLng, dLat, dRad) - earthVelocity;
+            e.gLng = geo.getLongitude(RADS);
+            e.gLat = geo.getLatitude(RADS);
+            e.gRad = geo.getRadius(AU);
+        }
+
+        e.vx = velocity.x;
+        e.vy = velocity.y;
+        e.vz = velocity.z;
+
+        Equatorial eq = CoordOps::toEquatorial(obliquity, e.gLng, e.gLat);
+        e.ra = eq.getRightAscension(RADS);
+        e.dec = eq.getDeclination(RADS);
+    }
+}
+
+const SolarSystemSnapshot::Entry& SolarSystemSnapshot::getEntry( BodyId _id ) const {
+    static const Entry empty = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if ( _id < SUN || _id > LUNA ) {
+        return empty;
+    }
+    return m_table[_id];
+}
+
+Ecliptic SolarSystemSnapshot::getEclipticHeliocentric( BodyId _id ) const {
+    const Entry& e = getEntry(_id);
+    return Ecliptic(e.hLng, e.hLat, e.hRad, RADS, AU);
+}
+
+Ecliptic SolarSystemSnapshot::getEclipticGeocentric( BodyId _id ) const {
+    const Entry& e = getEntry(_id);
+    return Ecliptic(e.gLng, e.gLat, e.gRad, RADS, AU);
+}
+
+Equatorial SolarSystemSnapshot::getEquatorial( BodyId _id ) const {
+    const Entry& e = getEntry(_id);
+    return Equatorial(e.ra, e.dec, RADS);
+}
+
+Vector3 SolarSystemSnapshot::getEclipticVelocity( BodyId _id ) const {
+    const Entry& e = getEntry(_id);
+    return Vector3(e.vx, e.vy, e.vz);
+}
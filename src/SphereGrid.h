@@ -0,0 +1,128 @@
+/*****************************************************************************\
+ * SphereGrid.h
+ *
+ * Internal index of points on the sphere by latitude zone and longitude
+ * cell, shared by StarIndex (stars by declination / right ascension) and
+ * GeoOps (cities by latitude / longitude). Not installed.
+ *
+\*****************************************************************************/
+
+#pragma once
+
+#include "hypatia/MathOps.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+namespace hypatia {
+
+// Zones of equal height in latitude, each split in cells of equal width in longitude,
+// holding the ids of the points inside. Angles in radians
+struct SphereGrid {
+    std::vector<int>    zoneFirst;  // zones + 1 offsets into the cells
+    std::vector<int>    cellFirst;  // cells + 1 offsets into ids
+    std::vector<int>    ids;        // point ids by cell, ascending in each cell
+    double              zoneDegs;   // height of the zones (degrees)
+
+    // widens the cell search, so points right on a cell border are never missed by rounding
+    static constexpr double MARGIN = 1e-9;
+
+    // _zoneDegs high zones. With _equalArea the cells are about as wide as high along the
+    // zone edge closest to the equator, otherwise every zone has 360 / _zoneDegs cells
+    SphereGrid( double _zoneDegs, bool _equalArea ) : zoneDegs(_zoneDegs) {
+        const int zones = (int)ceil(180.0 / _zoneDegs);
+        zoneFirst.resize(zones + 1);
+        zoneFirst[0] = 0;
+        for (int z = 0; z < zones; z++) {
+            int cells = (int)ceil(360.0 / _zoneDegs);
+            if (_equalArea) {
+                double lo = -90.0 + z * _zoneDegs;
+                double hi = lo + _zoneDegs;
+                double edge = (lo < 0.0 && hi > 0.0) ? 0.0 : std::min(fabs(lo), fabs(hi));
+                cells = std::max(1, (int)(360.0 * cos(MathOps::toRadians(edge)) / _zoneDegs));
+            }
+            zoneFirst[z + 1] = zoneFirst[z] + cells;
+        }
+    }
+
+    int getZones() const { return (int)zoneFirst.size() - 1; }
+    int getCells() const { return zoneFirst.back(); }
+    int getCells( int _zone ) const { return zoneFirst[_zone + 1] - zoneFirst[_zone]; }
+
+    int getZone( double _lat ) const {
+        int z = (int)floor( (MathOps::toDegrees(_lat) + 90.0) / zoneDegs );
+        return std::max(0, std::min(getZones() - 1, z));
+    }
+
+    int getCell( double _lng, double _lat ) const {
+        int z = getZone(_lat);
+        int cells = getCells(z);
+        int c = (int)floor( MathOps::normalize(_lng, RADS) / (MathOps::TAU / cells) );
+        return zoneFirst[z] + std::max(0, std::min(cells - 1, c));
+    }
+
+    // bucket the points 0 ... _cellOf.size() - 1 by cell, a cell of -1 leaves the point out
+    void fill( const std::vector<int>& _cellOf ) {
+        cellFirst.assign(getCells() + 1, 0);
+        for (size_t i = 0; i < _cellOf.size(); i++)
+            if (_cellOf[i] >= 0)
+                cellFirst[_cellOf[i] + 1]++;
+
+        for (size_t c = 1; c < cellFirst.size(); c++)
+            cellFirst[c] += cellFirst[c - 1];
+
+        ids.resize(cellFirst.back());
+        std::vector<int> next(cellFirst.begin(), cellFirst.end() - 1);
+        for (size_t i = 0; i < _cellOf.size(); i++)
+            if (_cellOf[i] >= 0)
+                ids[ next[_cellOf[i]]++ ] = (int)i;
+    }
+
+    // call _f( cell ) for every cell overlapping the circle of _radius around _lng, _lat
+    template<class F>
+    void forEachCell( double _lng, double _lat, double _radius, F _f ) const {
+        if (_radius + MARGIN >= MathOps::PI) {
+            for (int c = 0; c < getCells(); c++)
+                _f(c);
+            return;
+        }
+
+        const double latLo = _lat - _radius - MARGIN;
+        const double latHi = _lat + _radius + MARGIN;
+        const bool pole = latLo <= -MathOps::PI * 0.5 || latHi >= MathOps::PI * 0.5;
+
+        // half width in longitude of a circle that doesn't hold a pole
+        double halfWidth = MathOps::PI;
+        if (!pole)
+            halfWidth = asin( std::min(1.0, sin(_radius) / cos(_lat)) ) + MARGIN;
+
+        const double lng = MathOps::normalize(_lng, RADS);
+        for (int z = getZone(latLo); z <= getZone(latHi); z++) {
+            int cells = getCells(z);
+            double width = MathOps::TAU / cells;
+            int first = (int)floor( (lng - halfWidth) / width );
+            int last = (int)floor( (lng + halfWidth) / width );
+
+            if (pole || last - first + 1 >= cells) {
+                for (int c = 0; c < cells; c++)
+                    _f(zoneFirst[z] + c);
+            }
+            else {
+                for (int c = first; c <= last; c++)
+                    _f(zoneFirst[z] + ((c % cells) + cells) % cells);
+            }
+        }
+    }
+
+    // call _f( id ) for every point in the cells overlapping the circle
+    template<class F>
+    void forEachId( double _lng, double _lat, double _radius, F _f ) const {
+        forEachCell(_lng, _lat, _radius, [&](int _cell) {
+            for (int k = cellFirst[_cell]; k < cellFirst[_cell + 1]; k++)
+                _f(ids[k]);
+        });
+    }
+};
+
+}
@@ -3,11 +3,17 @@
 #include <string>
 
 #include "hypatia/CoordOps.h"
+#include "Lazy.h"
+#include <algorithm>
+#include <math.h>
 #include <string.h>
 
 #define N_STARS 2826
 const int Star::TOTAL = N_STARS;
 
+// stars handled per pass of the inner loops of computeAll(), small enough to stay on the stack
+static const int BLOCK = 256;
+
 // Hipparcos dataset ID
 static int sts_hip[N_STARS] = {
     677,	746,	765,	1067,	1562,	1599,	1645,	2021,	2072,	2081,	2484,	2920,	3092,	3179,	3419,	3760,	3821,	3881,	4427,	4436,	
@@ -1672,21 +1678,38 @@ static double sts_data[N_STARS][7] = {
 };
 #endif
 
+namespace {
+
+// catalog rows sorted by Hipparcos number, for binary search
+struct HIPIndex {
+    int hip[N_STARS];
+    int row[N_STARS];
+
+    HIPIndex() {
+        for (int i = 0; i < N_STARS; i++)
+            row[i] = i;
+        std::sort(row, row + N_STARS, [](int _a, int _b) { return sts_hip[_a] < sts_hip[_b]; });
+        for (int i = 0; i < N_STARS; i++)
+            hip[i] = sts_hip[row[i]];
+    }
+
+    int find( int _hip ) const {
+        const int* it = std::lower_bound(hip, hip + N_STARS, _hip);
+        if (it == hip + N_STARS || *it != _hip)
+            return -1;
+        return row[it - hip];
+    }
+};
+
+}
+
 Star::Star() : m_ha(0.0), m_id(-1) {
 }
 
 Star::Star( int _id, STAR_CATALOG _cat  ) :  m_ha(0.0), m_id(-1) {
     if (_cat == HIP) {
-        bool found = false;
-        for (int i = 0; i < N_STARS; i++) {
-            if (sts_hip[i] == _id) {
-                _id = i;
-                found = true;
-                break;
-            }
-        }
-
-        if (!found)
+        _id = hypatia::getLazy<HIPIndex>().find(_id);
+        if (_id < 0)
             return;
     }
     else if (_id < 0 || _id >= N_STARS ) 
@@ -1704,6 +1727,42 @@ Star::Star( double _ra, double _dec, double _mag ) : m_equatorial(_ra, _dec, DEG
 Star::~Star() {
 }
 
+/**
+ * getIdFromHIP() - catalog index of a Hipparcos number
+ *
+ * @param _hip - Hipparcos number
+ *
+ * @return index for Star( _id ), -1 if the star is not in the catalog
+ */
+int Star::getIdFromHIP( int _hip ) {
+    return hypatia::getLazy<HIPIndex>().find(_hip);
+}
+
+/**
+ * fromHIP() - stars of a list of Hipparcos numbers
+ *
+ * @param _hips - Hipparcos numbers
+ * @param _count - number of Hipparcos numbers
+ *
+ * @return one Star per number, in the same order. Numbers not in the catalog give
+ *         an empty Star (getId() == -1), as Star( _hip, HIP ) does
+ */
+std::vector<Star> Star::fromHIP( const int* _hips, size_t _count ) {
+    const HIPIndex& index = hypatia::getLazy<HIPIndex>();
+
+    std::vector<Star> stars(_count);
+    for (size_t i = 0; i < _count; i++) {
+        int id = index.find(_hips[i]);
+        if (id >= 0)
+            stars[i] = Star(id);
+    }
+    return stars;
+}
+
+std::vector<Star> Star::fromHIP( const std::vector<int>& _hips ) {
+    return fromHIP( _hips.data(), _hips.size() );
+}
+
 double Star::getHourAngle(ANGLE_UNIT _type) const {
     if (_type == DEGS) {
         return MathOps::toDegrees(m_ha);
@@ -1795,6 +1854,41 @@ void Star::compute( Observer& _obs) {
     }
 }
 
+void Star::compute(Observer& _obs, const EpochContext& _epoch) {
+    if ( _epoch.getJD() != _obs.getJD() ) {
+        compute(_obs);
+        return;
+    }
+
+    if ( _obs.haveLocation() ) {
+        Geodetic location = _obs.getLocation();
+        double ha = CoordOps::toHourAngle( _epoch.getLST(location.getLongitude(RADS)), m_equatorial.getRightAscension(RADS) );
+        m_ha = MathOps::normalize(ha, RADS);
+        m_horizontal = CoordOps::toHorizontal( location.getLatitude(RADS), ha, m_equatorial.getDeclination(RADS) );
+        m_bHorizontal = true;
+    }
+    else {
+        m_ha = 0.0;
+        m_horizontal[0] = 0.0;
+        m_horizontal[1] = 0.0;
+        m_bHorizontal = false;
+    }
+}
+
+void Star::compute(const ObserverState& _state) {
+    if ( _state.haveLocation() ) {
+        m_ha = MathOps::normalize(CoordOps::toHourAngle( _state, m_equatorial ), RADS);
+        m_horizontal = CoordOps::toHorizontal( _state, m_equatorial );
+        m_bHorizontal = true;
+    }
+    else {
+        m_ha = 0.0;
+        m_horizontal[0] = 0.0;
+        m_horizontal[1] = 0.0;
+        m_bHorizontal = false;
+    }
+}
+
 void Star::compute(Observer& _obs, const PrecessionMatrix& _matrix) {
     if ( _obs.haveLocation() ) {
         Equatorial eq = CoordOps::precess(_matrix, m_equatorial);
@@ -1808,4 +1902,145 @@ void Star::compute(Observer& _obs, const PrecessionMatrix& _matrix) {
         m_horizontal[1] = 0.0;
         m_bHorizontal = false;
     }
+}
+
+namespace {
+
+// unit vectors of the J2000 catalog positions, as structure-of-arrays
+struct CatalogVectors {
+    double x[N_STARS];
+    double y[N_STARS];
+    double z[N_STARS];
+
+    CatalogVectors() {
+        for (int i = 0; i < N_STARS; i++) {
+            hypatia::vec3 v = hypatia::toVector( Equatorial(sts_data[i][0], sts_data[i][1], DEGS).getCore() );
+            x[i] = v.x;
+            y[i] = v.y;
+            z[i] = v.z;
+        }
+    }
+};
+
+// rows of the horizon frame: north, east, zenith and the meridian ( cos(ha) * cos(dec) )
+// of an observer at latitude _lat with local sidereal time _lst, applied after _precession
+void horizonFrame( double _lat, double _lst, const hypatia::mat3& _precession, double _frame[4][3] ) {
+    const double sinLat = sin(_lat);
+    const double cosLat = cos(_lat);
+    const double sinLst = sin(_lst);
+    const double cosLst = cos(_lst);
+
+    const double rotation[4][3] = {
+        { -sinLat * cosLst, -sinLat * sinLst, cosLat },
+        { -sinLst,          cosLst,           0.0 },
+        { cosLat * cosLst,  cosLat * sinLst,  sinLat },
+        { cosLst,           sinLst,           0.0 }
+    };
+
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 3; j++)
+            _frame[i][j] = rotation[i][0] * _precession.m[0][j] + rotation[i][1] * _precession.m[1][j] + rotation[i][2] * _precession.m[2][j];
+}
+
+}
+
+/**
+ * computeCatalog() - horizontal coordinates of the whole catalog
+ *
+ * The precession and the change to the observer's horizon are folded in one
+ * 4x3 matrix, applied to the cached catalog vectors a block at a time. That
+ * pass is plain arithmetic on contiguous arrays the compiler vectorizes; only
+ * asin() and atan2() are left per star.
+ *
+ * @param _obs - Observer
+ * @param _precession - equatorial rotation applied to the J2000 vectors first
+ * @param _alt - output, TOTAL altitudes (radians)
+ * @param _az - output, TOTAL azimuths (radians)
+ * @param _ha - optional output, TOTAL hour angles (radians)
+ */
+static void computeCatalog( Observer& _obs, const hypatia::mat3& _precession, double* _alt, double* _az, double* _ha ) {
+    if ( !_obs.haveLocation() ) {
+        std::fill(_alt, _alt + N_STARS, 0.0);
+        std::fill(_az, _az + N_STARS, 0.0);
+        if (_ha)
+            std::fill(_ha, _ha + N_STARS, 0.0);
+        return;
+    }
+
+    double m[4][3];
+    horizonFrame( _obs.getLocation().getLatitude(RADS), _obs.getLST(), _precession, m );
+
+    const CatalogVectors& catalog = hypatia::getLazy<CatalogVectors>();
+
+    double north[BLOCK];
+    double east[BLOCK];
+    double up[BLOCK];
+    double meridian[BLOCK];
+
+    for (int begin = 0; begin < N_STARS; begin += BLOCK) {
+        const int n = std::min(BLOCK, N_STARS - begin);
+        const double* x = catalog.x + begin;
+        const double* y = catalog.y + begin;
+        const double* z = catalog.z + begin;
+
+        for (int i = 0; i < n; i++) {
+            north[i] = m[0][0] * x[i] + m[0][1] * y[i] + m[0][2] * z[i];
+            east[i] = m[1][0] * x[i] + m[1][1] * y[i] + m[1][2] * z[i];
+            up[i] = m[2][0] * x[i] + m[2][1] * y[i] + m[2][2] * z[i];
+            meridian[i] = m[3][0] * x[i] + m[3][1] * y[i] + m[3][2] * z[i];
+        }
+
+        for (int i = 0; i < n; i++) {
+            double az = atan2(east[i], north[i]);
+            _alt[begin + i] = asin( MathOps::clamp(up[i], -1.0, 1.0) );
+            _az[begin + i] = (az < 0.0) ? az + MathOps::TAU : az;
+        }
+
+        if (_ha) {
+            for (int i = 0; i < n; i++) {
+                double ha = atan2(-east[i], meridian[i]);
+                _ha[begin + i] = (ha < 0.0) ? ha + MathOps::TAU : ha;
+            }
+        }
+    }
+}
+
+/**
+ * computeAll() - horizontal coordinates of every star of the catalog
+ *
+ * @param _obs - Observer with a location
+ * @param _alt - output, TOTAL altitudes (radians)
+ * @param _az - output, TOTAL azimuths (radians)
+ * @param _ha - optional output, TOTAL hour angles (radians)
+ */
+void Star::computeAll( Observer& _obs, double* _alt, double* _az, double* _ha ) {
+    const hypatia::mat3 identity = {{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } }};
+    computeCatalog( _obs, identity, _alt, _az, _ha );
+}
+
+/**
+ * computeAll() - horizontal coordinates of every star of the catalog precessed from J2000
+ *
+ * @param _obs - Observer with a location
+ * @param _matrix - precession, as in CoordOps::precess()
+ * @param _alt - output, TOTAL altitudes (radians)
+ * @param _az - output, TOTAL azimuths (radians)
+ * @param _ha - optional output, TOTAL hour angles (radians)
+ */
+void Star::computeAll( Observer& _obs, const PrecessionMatrix& _matrix, double* _alt, double* _az, double* _ha ) {
+    // PrecessionMatrix::precess() applies the transpose, deprecess() the matrix itself
+    hypatia::mat3 m = _matrix.getCore();
+    computeCatalog( _obs, _matrix.isBackward() ? m : hypatia::transpose(m), _alt, _az, _ha );
+}
+
+void Star::computeAll( Observer& _obs, std::vector<double>& _alt, std::vector<double>& _az ) {
+    _alt.resize(N_STARS);
+    _az.resize(N_STARS);
+    computeAll( _obs, _alt.data(), _az.data() );
+}
+
+void Star::computeAll( Observer& _obs, const PrecessionMatrix& _matrix, std::vector<double>& _alt, std::vector<double>& _az ) {
+    _alt.resize(N_STARS);
+    _az.resize(N_STARS);
+    computeAll( _obs, _matrix, _alt.data(), _az.data() );
 }
\ No newline at end of file
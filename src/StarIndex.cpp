@@ -0,0 +1,166 @@
+/*****************************************************************************\
+ * StarIndex.cpp
+ *
+ * Declination zones and right ascension cells over the star catalog.
+ *
+\*****************************************************************************/
+
+#include "hypatia/StarIndex.h"
+
+#include "hypatia/MathOps.h"
+
+#include "Lazy.h"
+#include "SphereGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+const double StarIndex::MAG_ALL = 1e9;
+
+// height of the declination zones, and about the width of their cells (degrees)
+static const double ZONE_DEGS = 4.0;
+
+namespace {
+
+struct Grid : hypatia::SphereGrid {
+    std::vector<hypatia::vec3>  vectors;    // J2000 unit vector of each catalog id
+    std::vector<double>         mags;       // magnitude of each catalog id
+
+    // ids of each cell sorted by magnitude
+    Grid() : SphereGrid(ZONE_DEGS, true) {
+        std::vector<int> cellOfStar(Star::TOTAL);
+        vectors.resize(Star::TOTAL);
+        mags.resize(Star::TOTAL);
+
+        for (int i = 0; i < Star::TOTAL; i++) {
+            Star star(i);
+            Equatorial position = star.getEquatorial();
+            vectors[i] = hypatia::toVector(position.getCore());
+            mags[i] = star.getMagnitud();
+            cellOfStar[i] = getCell(position.getRightAscension(RADS), position.getDeclination(RADS));
+        }
+
+        fill(cellOfStar);
+        for (size_t c = 0; c + 1 < cellFirst.size(); c++)
+            std::sort(ids.begin() + cellFirst[c], ids.begin() + cellFirst[c + 1], [this](int _a, int _b) {
+                return (mags[_a] != mags[_b]) ? mags[_a] < mags[_b] : _a < _b;
+            });
+    }
+
+    // stars of a cell passing _inside, stopping at the magnitude limit
+    template<class F>
+    void collect( int _cell, double _magLimit, F _inside, std::vector<int>& _out ) const {
+        for (int k = cellFirst[_cell]; k < cellFirst[_cell + 1]; k++) {
+            int id = ids[k];
+            if (mags[id] > _magLimit)
+                break;
+            if (_inside(vectors[id]))
+                _out.push_back(id);
+        }
+    }
+
+    void sort( std::vector<int>& _ids ) const {
+        std::sort(_ids.begin(), _ids.end(), [this](int _a, int _b) {
+            return (mags[_a] != mags[_b]) ? mags[_a] < mags[_b] : _a < _b;
+        });
+    }
+};
+
+}
+
+/**
+ * starsInCone() - stars around a position
+ *
+ * @param _center - center of the cone (J2000)
+ * @param _radius - angular radius of the cone
+ * @param _type - unit of _radius
+ * @param _magLimit - faintest magnitude returned
+ *
+ * @return catalog ids, brightest first
+ */
+std::vector<int> StarIndex::starsInCone( const Equatorial& _center, double _radius, ANGLE_UNIT _type, double _magLimit ) {
+    const Grid& grid = hypatia::getLazy<Grid>();
+    std::vector<int> stars;
+
+    double radius = (_type == DEGS) ? MathOps::toRadians(_radius) : _radius;
+    if (radius < 0.0)
+        return stars;
+
+    const hypatia::vec3 center = hypatia::toVector(_center.getCore());
+    const double cosRadius = cos(radius);
+
+    grid.forEachCell(_center.getRightAscension(RADS), _center.getDeclination(RADS), radius, [&](int _cell) {
+        grid.collect(_cell, _magLimit, [&](const hypatia::vec3& _v) { return hypatia::dot(center, _v) >= cosRadius; }, stars);
+    });
+
+    grid.sort(stars);
+    return stars;
+}
+
+/**
+ * starsInPolygon() - stars inside a field of view
+ *
+ * The cells are searched over the cone around the vertices' mean direction
+ * that holds the whole polygon. A star is inside when it lies on the same
+ * side of every edge's great circle as that center.
+ *
+ * @param _vertices - vertices of a convex spherical polygon (J2000), in order
+ * @param _magLimit - faintest magnitude returned
+ *
+ * @return catalog ids, brightest first
+ */
+std::vector<int> StarIndex::starsInPolygon( const std::vector<Equatorial>& _vertices, double _magLimit ) {
+    const Grid& grid = hypatia::getLazy<Grid>();
+    std::vector<int> stars;
+
+    const size_t n = _vertices.size();
+    if (n < 3)
+        return stars;
+
+    std::vector<hypatia::vec3> vertices(n);
+    hypatia::vec3 sum = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < n; i++) {
+        vertices[i] = hypatia::toVector(_vertices[i].getCore());
+        sum = sum + vertices[i];
+    }
+    const hypatia::vec3 center = hypatia::normalize(sum);
+
+    // every point of an edge is within half its length of one of its ends
+    double radius = 0.0;
+    double halfEdge = 0.0;
+    std::vector<hypatia::vec3> normals(n);
+    for (size_t i = 0; i < n; i++) {
+        const hypatia::vec3& a = vertices[i];
+        const hypatia::vec3& b = vertices[(i + 1) % n];
+        radius = std::max(radius, acos( MathOps::clamp(hypatia::dot(center, a), -1.0, 1.0) ));
+        halfEdge = std::max(halfEdge, 0.5 * acos( MathOps::clamp(hypatia::dot(a, b), -1.0, 1.0) ));
+
+        // oriented so the center is on the positive side
+        normals[i] = hypatia::cross(a, b);
+        if (hypatia::dot(normals[i], center) < 0.0)
+            normals[i] = -normals[i];
+    }
+    radius += halfEdge;
+
+    auto inside = [&](const hypatia::vec3& _v) {
+        for (size_t i = 0; i < n; i++)
+            if (hypatia::dot(normals[i], _v) < 0.0)
+                return false;
+        return true;
+    };
+
+    grid.forEachCell(hypatia::toPhi(center), hypatia::toTheta(center), radius, [&](int _cell) {
+        grid.collect(_cell, _magLimit, inside, stars);
+    });
+
+    grid.sort(stars);
+    return stars;
+}
+
+int StarIndex::getTotalCells() {
+    return hypatia::getLazy<Grid>().getCells();
+}
+
+int StarIndex::getCell( const Equatorial& _position ) {
+    return hypatia::getLazy<Grid>().getCell(_position.getRightAscension(RADS), _position.getDeclination(RADS));
+}
@@ -94,5 +94,5 @@ double Ecliptic::getRadius (DISTANCE_UNIT _type) const {
 }
 
 Vector3 Ecliptic::getVector (DISTANCE_UNIT _type) const {
-    return Vector3(*this) * getRadius(_type);
+    return hypatia::fromPolar(m_phi, m_theta) * getRadius(_type);
 }
@@ -43,7 +43,7 @@ double Equatorial::getDeclination(ANGLE_UNIT _type) const {
 }
 
 Vector3 Equatorial::getVector() const {
-    return Vector3(*this);
+    return hypatia::fromPolar(m_phi, m_theta);
 }
 
 double Equatorial::getAngularDistance(const Equatorial& _equ, ANGLE_UNIT _type) const {
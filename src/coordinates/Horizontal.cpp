@@ -43,5 +43,5 @@ double Horizontal::getAzimuth(ANGLE_UNIT _type) const {
 }
 
 Vector3 Horizontal::getVector () const {
-    return Vector3(Polar(m_phi, -m_theta, RADS));
+    return hypatia::fromPolar(m_phi, -m_theta);
 }
@@ -0,0 +1,289 @@
+/*****************************************************************************\
+ * ChebyshevEphemeris.cpp
+ *
+ * Chebyshev-compressed ephemeris of the planets, Pluto and Luna.
+ *
+ * Each interval is fitted by interpolating the full model at the degree+1
+ * Chebyshev nodes (zeros of T_{degree+1}), which gives near-minimax
+ * polynomials, and evaluated with Clenshaw's recurrence.
+ *
+\*****************************************************************************/
+
+#include "hypatia/models/ChebyshevEphemeris.h"
+
+#include "hypatia/Luna.h"
+#include "hypatia/TimeOps.h"
+#include "hypatia/models/Exception.h"
+#include "hypatia/models/Pluto.h"
+#include "hypatia/models/VSOP87.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+const uint32_t ChebyshevEphemeris::VERSION = 1;
+
+static const char       CHEB_MAGIC[8] = { 'H', 'Y', 'P', 'C', 'H', 'E', 'B', '\0' };
+static const uint32_t   CHEB_ENDIAN = 0x01020304;
+
+// Highest degree load() accepts, well above the layout below
+static const uint32_t   CHEB_MAX_DEGREE = 32;
+
+// Interval length (days) and degree per body, after the JPL DE layout
+struct ChebyshevLayout {
+    BodyId  id;
+    double  span;
+    int     degree;
+};
+
+static const ChebyshevLayout layout[] = {
+    { MERCURY,  8.0, 13 },
+    { VENUS,   16.0, 11 },
+    { EARTH,   16.0, 13 },
+    { MARS,    16.0, 11 },
+    { JUPITER, 32.0,  9 },
+    { SATURN,  32.0,  9 },
+    { URANUS,  64.0,  7 },
+    { NEPTUNE, 64.0,  7 },
+    { PLUTO,   64.0,  7 },
+    { LUNA,     4.0, 13 }
+};
+static const int layoutTotal = sizeof(layout) / sizeof(layout[0]);
+
+// Position the coefficients are fitted to: heliocentric for planets, geocentric for Luna
+static Vector3 modelPosition( BodyId _id, double _jd ) {
+    double lng, lat, rad = 0.0;
+
+    if (_id == LUNA) {
+        return Luna::computeGeocentric(TimeOps::toJC(_jd)).getVector(AU);
+    }
+    else if (_id == PLUTO) {
+        Pluto::calcAllLocs(lng, lat, rad, TimeOps::toJC(_jd));
+    }
+    else {
+        VSOP87::calcAllLocs(lng, lat, rad, TimeOps::toJC(_jd), _id);
+    }
+
+    return Ecliptic(lng, lat, rad, RADS, AU).getVector(AU);
+}
+
+// Sum of c[i] x T_i(x) by Clenshaw's recurrence
+static inline double clenshaw( const double* _c, int _n, double _x ) {
+    double x2 = 2.0 * _x;
+    double b1 = 0.0, b2 = 0.0;
+    for (int i = _n - 1; i > 0; i--) {
+        double b0 = _c[i] + x2 * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return _c[0] + _x * b1 - b2;
+}
+
+ChebyshevEphemeris::ChebyshevEphemeris() : m_jdStart(0.0), m_jdEnd(0.0) {
+    memset(m_bodies, 0, sizeof(m_bodies));
+}
+
+ChebyshevEphemeris::ChebyshevEphemeris( const std::string& _filename ) : m_jdStart(0.0), m_jdEnd(0.0) {
+    memset(m_bodies, 0, sizeof(m_bodies));
+    load(_filename);
+}
+
+ChebyshevEphemeris::~ChebyshevEphemeris() {
+    close();
+}
+
+void ChebyshevEphemeris::build( const std::string& _filename, double _jdStart, double _jdEnd ) {
+    if ( !(_jdEnd > _jdStart) )
+        throw Exception("Empty ephemeris range");
+
+    ChebyshevHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHEB_MAGIC, sizeof(CHEB_MAGIC));
+    header.version = VERSION;
+    header.endian = CHEB_ENDIAN;
+    header.bodies = layoutTotal;
+    header.jdStart = _jdStart;
+    header.jdEnd = _jdEnd;
+
+    // Intervals are aligned on J2000 so none straddles it: Luna's series use the century
+    // normalized to [0, 360) as T, which jumps there and can't be fitted by a polynomial
+    ChebyshevBody records[layoutTotal];
+    uint64_t offset = sizeof(ChebyshevHeader) + sizeof(records);
+    for (int b = 0; b < layoutTotal; b++) {
+        const double jdStart = TimeOps::J2000 + floor( (_jdStart - TimeOps::J2000) / layout[b].span ) * layout[b].span;
+
+        memset(&records[b], 0, sizeof(ChebyshevBody));
+        records[b].id = layout[b].id;
+        records[b].degree = layout[b].degree;
+        records[b].intervals = (uint32_t)ceil( (_jdEnd - jdStart) / layout[b].span );
+        records[b].jdStart = jdStart;
+        records[b].span = layout[b].span;
+        records[b].offset = offset;
+        offset += (uint64_t)records[b].intervals * 3 * (layout[b].degree + 1) * sizeof(double);
+    }
+
+    FILE* file = fopen(_filename.c_str(), "wb");
+    if (!file)
+        throw Exception("Can't open ephemeris file for writing");
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(records, sizeof(records), 1, file) == 1;
+
+    for (int b = 0; b < layoutTotal && ok; b++) {
+        const int n = layout[b].degree + 1;
+        std::vector<double> cosines(n * n);
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k < n; k++)
+                cosines[j * n + k] = cos( MathOps::PI * j * (k + 0.5) / n );
+
+        std::vector<Vector3> samples(n);
+        std::vector<double> coeffs(3 * n);
+        for (uint32_t i = 0; i < records[b].intervals && ok; i++) {
+            double half = 0.5 * layout[b].span;
+            double mid = records[b].jdStart + i * layout[b].span + half;
+
+            // sample at the nodes x_k = cos( PI (k + 1/2) / n ), in [-1, 1]
+            for (int k = 0; k < n; k++)
+                samples[k] = modelPosition(layout[b].id, mid + half * cosines[n + k]);
+
+            for (int j = 0; j < n; j++) {
+                double x = 0.0, y = 0.0, z = 0.0;
+                for (int k = 0; k < n; k++) {
+                    double c = cosines[j * n + k];
+                    x += samples[k].x * c;
+                    y += samples[k].y * c;
+                    z += samples[k].z * c;
+                }
+                double f = (j == 0) ? 1.0 / n : 2.0 / n;
+                coeffs[j] = x * f;
+                coeffs[n + j] = y * f;
+                coeffs[2 * n + j] = z * f;
+            }
+
+            ok = fwrite(coeffs.data(), sizeof(double), coeffs.size(), file) == coeffs.size();
+        }
+    }
+
+    if (fclose(file) != 0 || !ok)
+        throw Exception("Failed to write ephemeris file");
+}
+
+void ChebyshevEphemeris::load( const std::string& _filename ) {
+    close();
+
+    m_file.open(_filename);
+    const char* data = m_file.getData();
+    const size_t size = m_file.getSize();
+
+    const ChebyshevHeader* header = (const ChebyshevHeader*)data;
+    if (size < sizeof(ChebyshevHeader) ||
+        memcmp(header->magic, CHEB_MAGIC, sizeof(CHEB_MAGIC)) != 0 ||
+        header->endian != CHEB_ENDIAN ||
+        header->version != VERSION ||
+        (uint64_t)header->bodies * sizeof(ChebyshevBody) > size - sizeof(ChebyshevHeader) ||
+        !(header->jdStart <= header->jdEnd)) {
+        close();
+        throw Exception("Invalid ephemeris file or version");
+    }
+
+    const ChebyshevBody* records = (const ChebyshevBody*)(data + sizeof(ChebyshevHeader));
+    for (uint32_t b = 0; b < header->bodies; b++) {
+        const ChebyshevBody& r = records[b];
+        if (r.id < SUN || r.id > LUNA || r.intervals == 0 || r.degree > CHEB_MAX_DEGREE || !(r.span > 0.0)) {
+            close();
+            throw Exception("Invalid ephemeris body record");
+        }
+
+        // no overflow: intervals < 2^32 and degree <= CHEB_MAX_DEGREE
+        uint64_t bytes = (uint64_t)r.intervals * 3 * (r.degree + 1) * sizeof(double);
+        if (r.offset % sizeof(double) != 0 || r.offset > size || bytes > size - r.offset) {
+            close();
+            throw Exception("Invalid ephemeris body record");
+        }
+
+        // the intervals must cover the whole file range, so eval() never indexes before the
+        // first one (the end may fall short of jdEnd by rounding, the last interval is extended)
+        if ( !(r.jdStart <= header->jdStart) ||
+             !(r.jdStart + r.intervals * r.span >= header->jdEnd - 1e-6 * r.span) ) {
+            close();
+            throw Exception("Ephemeris body record doesn't cover the file range");
+        }
+        m_bodies[r.id] = &r;
+    }
+
+    m_jdStart = header->jdStart;
+    m_jdEnd = header->jdEnd;
+}
+
+void ChebyshevEphemeris::close() {
+    m_file.close();
+    m_jdStart = m_jdEnd = 0.0;
+    memset(m_bodies, 0, sizeof(m_bodies));
+}
+
+bool ChebyshevEphemeris::have( BodyId _id ) const {
+    if (_id < SUN || _id > LUNA)
+        return false;
+    else if (_id == SUN)
+        return m_bodies[EARTH] != 0;
+    return m_bodies[_id] != 0;
+}
+
+/**
+ * eval() - evaluate the polynomials fitted for a body
+ *
+ * @param _id - body stored in the file
+ * @param _jd - julian day inside [getJDStart(), getJDEnd()]
+ *
+ * @return position in AU (heliocentric for planets, geocentric for Luna)
+ */
+Vector3 ChebyshevEphemeris::eval( BodyId _id, double _jd ) const {
+    if (_id < SUN || _id > LUNA || !m_bodies[_id])
+        throw Exception("Body not in ephemeris");
+
+    if (_jd < m_jdStart || _jd > m_jdEnd)
+        throw Exception("Julian day out of ephemeris range");
+
+    const ChebyshevBody& r = *m_bodies[_id];
+    double t = (_jd - r.jdStart) / r.span;
+    uint32_t i = (uint32_t)t;
+    if (i >= r.intervals)
+        i = r.intervals - 1;
+
+    const int n = r.degree + 1;
+    const double* c = (const double*)(m_file.getData() + r.offset) + (size_t)i * 3 * n;
+    double x = 2.0 * (t - i) - 1.0;
+
+    return Vector3( clenshaw(c, n, x), clenshaw(c + n, n, x), clenshaw(c + 2 * n, n, x) );
+}
+
+Vector3 ChebyshevEphemeris::getHeliocentricVector( BodyId _id, double _jd ) const {
+    if (_id == SUN)
+        return Vector3(0.0, 0.0, 0.0);
+    else if (_id == LUNA)
+        return eval(EARTH, _jd) + eval(LUNA, _jd);
+    return eval(_id, _jd);
+}
+
+Vector3 ChebyshevEphemeris::getGeocentricVector( BodyId _id, double _jd ) const {
+    if (_id == EARTH)
+        return Vector3(0.0, 0.0, 0.0);
+    else if (_id == SUN)
+        return eval(EARTH, _jd) * -1.0;
+    else if (_id == LUNA)
+        return eval(LUNA, _jd);
+    return eval(_id, _jd) - eval(EARTH, _jd);
+}
+
+Ecliptic ChebyshevEphemeris::getEclipticHeliocentric( BodyId _id, double _jd ) const {
+    if (_id == SUN)
+        return Ecliptic(eval(EARTH, _jd), AU);
+    return Ecliptic(getHeliocentricVector(_id, _jd), AU);
+}
+
+Ecliptic ChebyshevEphemeris::getEclipticGeocentric( BodyId _id, double _jd ) const {
+    if (_id == EARTH)
+        return Ecliptic(0.0, 0.0, 0.0, RADS, AU);
+    return Ecliptic(getGeocentricVector(_id, _jd), AU);
+}
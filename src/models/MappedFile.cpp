@@ -0,0 +1,87 @@
+/*****************************************************************************\
+ * MappedFile.cpp
+ *
+ * Read-only view of a binary data file.
+ *
+\*****************************************************************************/
+
+#include "hypatia/models/MappedFile.h"
+
+#include "hypatia/models/Exception.h"
+
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : m_data(0), m_size(0), m_mapped(false) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::open( const std::string& _filename ) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(_filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Exception("Can't open file");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw Exception("Empty or unreadable file");
+    }
+
+    void* addr = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        throw Exception("Can't map file");
+
+    m_data = (const char*)addr;
+    m_size = st.st_size;
+    m_mapped = true;
+#else
+    FILE* file = fopen(_filename.c_str(), "rb");
+    if (!file)
+        throw Exception("Can't open file");
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(file);
+        throw Exception("Empty or unreadable file");
+    }
+
+    // doubles keep the contents aligned
+    m_buffer.resize( (size + sizeof(double) - 1) / sizeof(double) );
+    size_t read = fread(m_buffer.data(), 1, size, file);
+    fclose(file);
+    if (read != (size_t)size) {
+        m_buffer.clear();
+        throw Exception("Can't read file");
+    }
+
+    m_data = (const char*)m_buffer.data();
+    m_size = size;
+    m_mapped = false;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (m_mapped && m_data)
+        munmap((void*)m_data, m_size);
+#endif
+    m_buffer.clear();
+    m_data = 0;
+    m_size = 0;
+    m_mapped = false;
+}
@@ -10,6 +10,7 @@
 
 #include "hypatia/MathOps.h"
 #include "hypatia/CoordOps.h"
+#include "hypatia/TimeOps.h"
 #include "hypatia/models/Pluto.h"
 
 #include <math.h>
@@ -140,6 +141,76 @@ void reduceElements ( double mj0, double mj, double inc0, double ap0, double om0
         *inc = 1.570796327-asin((cinc*ceta)+(sinc*seta*cot));
 }
 
+/**
+ * reduceElementRates() - rates of the elements returned by reduceElements()
+ *
+ * Derivatives of the same expressions, so they hold where the elements are
+ * reduced (they are left as is by reduceElements() within 1e-5 days of mj0).
+ *
+ * @param - mj0, initial epoch
+ * @param - mj, desired epoch
+ * @param - inc0, initial inclination, rads
+ * @param - om0, initial long of ascending node, rads
+ * @param - dinc, inclination rate, rads per day
+ * @param - dap, arg of perihelion rate, rads per day
+ * @param - dom, long of ascending node rate, rads per day
+ *
+ */
+void reduceElementRates ( double mj0, double mj, double inc0, double om0, double *dinc, double *dap, double *dom) {
+    const double k = MathOps::toRadians(1.0/3600.0) / 365250.0;   /* arcsec per millennium -> rads per day */
+
+    double t0 = mj0/365250.0;
+    double t1 = mj/365250.0;
+    double tt = t1-t0;
+    double tt2 = tt*tt;
+    double t02 = t0*t0;
+    double tt3 = tt*tt2;
+
+    double eta = (471.07-6.75*t0+.57*t02)*tt+(.57*t0-3.37)*tt2+.05*tt3;
+    double th0 = 32869.0*t0+56*t02-(8694+55*t0)*tt+3*tt2;
+    eta = MathOps::toRadians(eta/3600.0);
+    th0 = MathOps::toRadians((th0/3600.0)+173.950833);
+
+    double deta = ((471.07-6.75*t0+.57*t02)+2*(.57*t0-3.37)*tt+.15*tt2) * k;
+    double dth0 = (-(8694+55*t0)+6*tt) * k;
+    double dth = dth0 + ((50256.41+222.29*t0+.26*t02)+2*(111.15+.26*t0)*tt+.3*tt2) * k;
+
+    double cinc = cos(inc0);
+    double sinc = sin(inc0);
+    double ot = om0-th0;
+    double dot = -dth0;
+    double sot = sin(ot);
+    double cot = cos(ot);
+    double seta = sin(eta);
+    double ceta = cos(eta);
+
+    /* d/dt atan(a/b) = (a' b - a b') / (a^2 + b^2) */
+    double a = sinc*sot;
+    double b = ceta*sinc*cot-seta*cinc;
+    double da = sinc*cot*dot;
+    double db = -seta*deta*sinc*cot-ceta*sinc*sot*dot-ceta*deta*cinc;
+    *dom = (da*b-a*db)/(a*a+b*b) + dth;
+
+    b = sinc*ceta-cinc*seta*cot;
+    a = -1*seta*sot;
+    db = -sinc*seta*deta-cinc*(ceta*deta*cot-seta*sot*dot);
+    da = -(ceta*deta*sot+seta*cot*dot);
+    *dap = (da*b-a*db)/(a*a+b*b);
+
+    if (inc0<.175) {
+        double dap0 = atan(a/b);
+        double s = sin(dap0);
+        double u = a/s;
+        double du = (da*s-a*cos(dap0)*(*dap))/(s*s);
+        *dinc = du/sqrt(1.0-u*u);
+    }
+    else {
+        double w = (cinc*ceta)+(sinc*seta*cot);
+        double dw = -cinc*seta*deta+sinc*(ceta*deta*cot-seta*sot*dot);
+        *dinc = -dw/sqrt(1.0-w*w);
+    }
+}
+
 #define MJD0  2415020.0
 
 // t is in julian centuries from J2000.0
@@ -248,3 +319,105 @@ void Pluto::calcAllLocs (double& _lon, double& _lat, double& _rad, const double
     _rad = rad / 10.;                  // convert back to AUs
 #endif
 }
+
+// Same as calcAllLocs() with the rates (per day) from the derivatives of the same expressions
+void Pluto::calcAllLocsAndRates (double& _lon, double& _lat, double& _rad, double& _dLon, double& _dLat, double& _dRad, const double _jc) {
+#ifdef XEPHEM
+
+    double mj = (_jc * TimeOps::DAYS_PER_CENTURY) + TimeOps::J2000;
+    double a = 39.543;
+    double e = 0.2490;
+    double inc0 = MathOps::toRadians(17.140);
+    double Om0 = MathOps::toRadians(110.307);
+    double omeg0 = MathOps::toRadians(113.768);
+    double mjp = 2448045.539;
+    double mjeq = TimeOps::J2000;
+    double n = 144.9600/ TimeOps::DAYS_PER_CENTURY;
+
+    double inc, Om, omeg;
+    double dinc, dOm, domeg;
+    double ma, ea, nu;
+    double lo, slo, clo;
+
+    reduceElements(mjeq, mj, inc0, omeg0, Om0, &inc, &omeg, &Om);
+    reduceElementRates(mjeq, mj, inc0, Om0, &dinc, &domeg, &dOm);
+
+    ma = MathOps::toRadians((mj - mjp) * n);
+    CoordOps::anomaly(ma, e, &nu, &ea);
+
+    _rad = a * (1.0 - e*cos(ea));
+    lo = omeg + nu;
+    slo = sin(lo);
+    clo = cos(lo);
+    _lat = asin(slo * sin(inc));
+    _lon = atan2(slo * cos(inc), clo) + Om;
+
+    /* Kepler's equation: E' = M' / (1 - e cos E), nu' = sqrt(1 - e^2) / (1 - e cos E) E' */
+    double q = 1.0 - e*cos(ea);
+    double dea = MathOps::toRadians(n) / q;
+    double dlo = domeg + sqrt(1.0 - e*e) / q * dea;
+
+    _dRad = a * e * sin(ea) * dea;
+    _dLat = (clo * sin(inc) * dlo + slo * cos(inc) * dinc) / cos(_lat);
+    _dLon = (cos(inc) * dlo - slo * clo * sin(inc) * dinc) / (slo * slo * cos(inc) * cos(inc) + clo * clo) + dOm;
+
+#else
+    calcAllLocs(_lon, _lat, _rad, _jc);
+
+    double mlJup =  MathOps::toRadians(34.35 + 3034.9057 * _jc);
+    double mlSat =  MathOps::toRadians(50.08 + 1222.1138 * _jc);
+    double mlPl = MathOps::toRadians(238.96 +  144.9600 * _jc);
+
+    // rates of the mean longitudes, radians per julian century
+    double dJup = MathOps::toRadians(3034.9057);
+    double dSat = MathOps::toRadians(1222.1138);
+    double dPl = MathOps::toRadians(144.9600);
+
+    // degrees (tenths of AUs for the radius) per julian century
+    double lon = 144.96;
+    double lat = 0.;
+    double rad = 0.;
+
+    double arg, dArg, cosArg, sinArg;
+    long* plc;
+    for (int i = 0; i < 7; i++) {
+        if ( i == 6 ) {
+            arg = mlJup - mlPl;
+            dArg = dJup - dPl;
+        }
+        else {
+            arg = (double)(i + 1) * mlPl;
+            dArg = (double)(i + 1) * dPl;
+        }
+
+        cosArg = cos(arg) * dArg * 1.e-6;
+        sinArg = -sin(arg) * dArg * 1.e-6;
+        plc = plutoLongCoeff[i];
+
+        lon += (double)(plc[0]) * cosArg + (double)(plc[1]) * sinArg;
+        lat += (double)(plc[2]) * cosArg + (double)(plc[3]) * sinArg;
+        rad += (double)(plc[4]) * cosArg + (double)(plc[5]) * sinArg;
+    }
+
+    PlutoCoeffs* pc = plutoCoeff;
+    for (int i=0; i<N_COEFFS; i++ ) {
+        if (pc->lon_a || pc->lon_b ||
+            pc->lat_a || pc->lat_b ||
+            pc->rad_a || pc->rad_b) {
+
+            arg = mlJup * (double)pc->j + mlSat * (double)pc->s + mlPl * (double)pc->p;
+            dArg = dJup * (double)pc->j + dSat * (double)pc->s + dPl * (double)pc->p;
+
+            cosArg = cos(arg) * dArg * 1.e-6;
+            sinArg = -sin(arg) * dArg * 1.e-6;
+            lon += cosArg * (double)(pc->lon_a) + sinArg * (double)(pc->lon_b);
+            lat += cosArg * (double)(pc->lat_a) + sinArg * (double)(pc->lat_b);
+            rad += cosArg * (double)(pc->rad_a) + sinArg * (double)(pc->rad_b);
+        }
+        pc++;
+    }
+    _dLon = MathOps::toRadians(lon) / TimeOps::DAYS_PER_CENTURY;
+    _dLat = MathOps::toRadians(lat) / TimeOps::DAYS_PER_CENTURY;
+    _dRad = rad / 10. / TimeOps::DAYS_PER_CENTURY;
+#endif
+}
@@ -10,6 +10,8 @@
 
 #include "hypatia/models/VSOP87.h"
 #include "hypatia/MathOps.h"
+#include "hypatia/TimeOps.h"
+#include "../Lazy.h"
 
 #include <math.h>
 
@@ -3234,6 +3236,142 @@ const AstroTerms NeptuneTerms = {
     VSOP87Terms( NeptuneRadTerms5Rows, NeptuneRadTerms5 ),
 };
 
+/*
+ * Return the term set of 'planet' (1=mercury ... 8=neptune) for the spec'd
+ * location element and power of t.  Out of range requests get an empty set.
+ */
+const VSOP87Terms& VSOP87::getTerms(BodyId planet,
+                                    LocType ltype,
+                                    int power) {
+    static const VSOP87Terms empty;
+
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2 || power < 0 || power > 5)
+        return empty;
+
+    const VSOP87Terms* pT;
+    switch ( planet ) {
+        case MERCURY: pT = &(MercuryTerms[ltype*6]); break;
+        case VENUS:   pT = &(VenusTerms[ltype*6]);   break;
+        case EARTH:   pT = &(EarthTerms[ltype*6]);   break;
+        case MARS:    pT = &(MarsTerms[ltype*6]);    break;
+        case JUPITER: pT = &(JupiterTerms[ltype*6]); break;
+        case SATURN:  pT = &(SaturnTerms[ltype*6]);  break;
+        case URANUS:  pT = &(UranusTerms[ltype*6]);  break;
+        case NEPTUNE: pT = &(NeptuneTerms[ltype*6]); break;
+        default: return empty;
+    };
+
+    return pT[power];
+}
+
+// * * * * * compile-time evaluators * * * * *
+
+namespace {
+
+// A x cos( B + C x t ) summed over the N rows of a series, N known at compile time
+template<unsigned N>
+inline double sumTerms( const VSOP87Set* pv, double t ) {
+    double sum = 0.;
+    for (unsigned j=0; j<N; j++)
+        sum += pv[j].A * cos( pv[j].B + pv[j].C * t );
+    return sum;
+}
+
+// empty series are null pointers in the tables
+template<>
+inline double sumTerms<0>( const VSOP87Set*, double ) {
+    return 0.;
+}
+
+// The six series of a location element, L = L0 + L1*t + L2*t^2 + ..., in the same
+// order of operations as the runtime loop of calcLoc()
+template<BodyId planet, VSOP87::LocType ltype>
+struct SeriesSum;
+
+#define VSOP87_SERIES_SUM( BODY, LOC, Name )                                    \
+template<>                                                                      \
+struct SeriesSum<BODY, VSOP87::LOC> {                                           \
+    static inline double sum( double t ) {                                      \
+        double rval = 0.0;                                                      \
+        double tPower = 1.0;                                                    \
+        rval += sumTerms<Name##0Rows>( Name##0, t ) * tPower;   tPower *= t;    \
+        rval += sumTerms<Name##1Rows>( Name##1, t ) * tPower;   tPower *= t;    \
+        rval += sumTerms<Name##2Rows>( Name##2, t ) * tPower;   tPower *= t;    \
+        rval += sumTerms<Name##3Rows>( Name##3, t ) * tPower;   tPower *= t;    \
+        rval += sumTerms<Name##4Rows>( Name##4, t ) * tPower;   tPower *= t;    \
+        rval += sumTerms<Name##5Rows>( Name##5, t ) * tPower;                   \
+        return rval;                                                            \
+    }                                                                           \
+};
+
+#define VSOP87_PLANET_SUMS( BODY, Name )                                        \
+    VSOP87_SERIES_SUM( BODY, ECLIPTIC_LON, Name##LonTerms )                     \
+    VSOP87_SERIES_SUM( BODY, ECLIPTIC_LAT, Name##LatTerms )                     \
+    VSOP87_SERIES_SUM( BODY, RADIUS, Name##RadTerms )
+
+VSOP87_PLANET_SUMS( MERCURY, Mercury )
+VSOP87_PLANET_SUMS( VENUS, Venus )
+VSOP87_PLANET_SUMS( EARTH, Earth )
+VSOP87_PLANET_SUMS( MARS, Mars )
+VSOP87_PLANET_SUMS( JUPITER, Jupiter )
+VSOP87_PLANET_SUMS( SATURN, Saturn )
+VSOP87_PLANET_SUMS( URANUS, Uranus )
+VSOP87_PLANET_SUMS( NEPTUNE, Neptune )
+
+#undef VSOP87_PLANET_SUMS
+#undef VSOP87_SERIES_SUM
+
+}
+
+template<BodyId planet, VSOP87::LocType ltype>
+double VSOP87::eval(double t) {
+    t /= 10.;          // convert to julian millenia
+
+    double rval = SeriesSum<planet, ltype>::sum( t );
+    rval *= 1.e-8;  // rescale the term
+
+    if (ECLIPTIC_LON == ltype) {  /* ensure 0 < rval < 2PI  */
+        rval = MathOps::normalize( rval, RADS );
+    }
+    return rval;
+}
+
+#define VSOP87_PLANET_EVALS( BODY )                                             \
+    template double VSOP87::eval<BODY, VSOP87::ECLIPTIC_LON>( double );         \
+    template double VSOP87::eval<BODY, VSOP87::ECLIPTIC_LAT>( double );         \
+    template double VSOP87::eval<BODY, VSOP87::RADIUS>( double );
+
+VSOP87_PLANET_EVALS( MERCURY )
+VSOP87_PLANET_EVALS( VENUS )
+VSOP87_PLANET_EVALS( EARTH )
+VSOP87_PLANET_EVALS( MARS )
+VSOP87_PLANET_EVALS( JUPITER )
+VSOP87_PLANET_EVALS( SATURN )
+VSOP87_PLANET_EVALS( URANUS )
+VSOP87_PLANET_EVALS( NEPTUNE )
+
+#undef VSOP87_PLANET_EVALS
+
+// evaluator of each planet and location element, used by the runtime calcLoc()
+typedef double (*VSOP87Evaluator)( double );
+
+#define VSOP87_PLANET_EVALUATORS( BODY ) \
+    { &VSOP87::eval<BODY, VSOP87::ECLIPTIC_LON>, &VSOP87::eval<BODY, VSOP87::ECLIPTIC_LAT>, &VSOP87::eval<BODY, VSOP87::RADIUS> }
+
+static const VSOP87Evaluator evaluators[NEPTUNE + 1][3] = {
+    { 0, 0, 0 },    // SUN
+    VSOP87_PLANET_EVALUATORS( MERCURY ),
+    VSOP87_PLANET_EVALUATORS( VENUS ),
+    VSOP87_PLANET_EVALUATORS( EARTH ),
+    VSOP87_PLANET_EVALUATORS( MARS ),
+    VSOP87_PLANET_EVALUATORS( JUPITER ),
+    VSOP87_PLANET_EVALUATORS( SATURN ),
+    VSOP87_PLANET_EVALUATORS( URANUS ),
+    VSOP87_PLANET_EVALUATORS( NEPTUNE )
+};
+
+#undef VSOP87_PLANET_EVALUATORS
+
 /*
  * This function, using the simplified VSOP87 data in Meeus, can compute
  * planetary positions in heliocentric ecliptic coordinates.
@@ -3253,6 +3391,106 @@ const AstroTerms NeptuneTerms = {
 double VSOP87::calcLoc(double t,         // time in decimal centuries
                      BodyId planet,
                      LocType ltype) {
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2)
+        return 0.0;
+
+    return evaluators[planet][ltype]( t );
+}
+
+// * * * * * accuracy tiers * * * * *
+
+namespace {
+
+const int N_TIERS = VSOP87::DEGREE + 1;
+
+// target error of each tier in arcseconds
+const double tierTargets[N_TIERS] = { 0.0, 1.0, 60.0, 3600.0 };
+
+/*
+ * Per tier number of kept terms of every series and the resulting worst-case
+ * error. With |cen| <= 10 centuries |t| <= 1 millenia, so no power of t can
+ * make a dropped term larger than its |A| and the error is bound by the sum
+ * of the dropped amplitudes. Terms are dropped from the tails of the six
+ * series of a location, smallest |A| first, while that sum stays under target.
+ */
+struct VSOP87Tiers {
+    unsigned    count[N_TIERS][NEPTUNE + 1][3][6];
+    double      bound[N_TIERS][NEPTUNE + 1][3];
+
+    VSOP87Tiers() {
+        for (int tier = 0; tier < N_TIERS; tier++) {
+            for (int p = MERCURY; p <= NEPTUNE; p++) {
+                for (int l = 0; l < 3; l++) {
+                    const VSOP87Terms* pT = &VSOP87::getTerms( (BodyId)p, (VSOP87::LocType)l, 0 );
+                    unsigned* cut = count[tier][p][l];
+                    for (int i = 0; i < 6; i++)
+                        cut[i] = pT[i].rows;
+
+                    double target = MathOps::secToRadians( tierTargets[tier] );
+                    if (l == VSOP87::RADIUS)
+                        target *= fabs( pT[0].pTerms[0].A ) * 1.e-8;  // mean distance
+
+                    double dropped = 0.0;
+                    while (true) {
+                        int next = -1;
+                        for (int i = 0; i < 6; i++) {
+                            if ( cut[i] > 0 && (next < 0 || fabs( pT[i].pTerms[cut[i]-1].A ) < fabs( pT[next].pTerms[cut[next]-1].A )) )
+                                next = i;
+                        }
+                        if (next < 0)
+                            break;
+
+                        double err = fabs( pT[next].pTerms[cut[next]-1].A ) * 1.e-8;
+                        if (dropped + err > target)
+                            break;
+
+                        dropped += err;
+                        cut[next]--;
+                    }
+                    bound[tier][p][l] = dropped;
+                }
+            }
+        }
+    }
+};
+
+}
+
+double VSOP87::getPrecisionTarget( Precision _precision ) {
+    if (_precision < FULL || _precision > DEGREE)
+        return 0.0;
+    return tierTargets[_precision];
+}
+
+unsigned VSOP87::getTermsCount(BodyId planet,
+                               LocType ltype,
+                               int power,
+                               Precision _precision) {
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2 || power < 0 || power > 5)
+        return 0;
+
+    if (_precision <= FULL || _precision > DEGREE)
+        return getTerms( planet, ltype, power ).rows;
+
+    return hypatia::getLazy<VSOP87Tiers>().count[_precision][planet][ltype][power];
+}
+
+double VSOP87::getErrorBound(BodyId planet,
+                             LocType ltype,
+                             Precision _precision) {
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2 || _precision <= FULL || _precision > DEGREE)
+        return 0.0;
+
+    return hypatia::getLazy<VSOP87Tiers>().bound[_precision][planet][ltype];
+}
+
+double VSOP87::calcLoc(double t,         // time in decimal centuries
+                     BodyId planet,
+                     LocType ltype,
+                     Precision _precision) {
+    if (_precision <= FULL || _precision > DEGREE)
+        return calcLoc( t, planet, ltype );
+
     double rval = 0.0;
     
     if (planet > SUN && planet < PLUTO && ltype >= 0 && ltype <=2) {
@@ -3260,26 +3498,17 @@ double VSOP87::calcLoc(double t,         // time in decimal centuries
         t /= 10.;          // convert to julian millenia
         double tPower = 1.0;
         
-        const VSOP87Terms* pT;
-        switch ( planet ) {
-            case MERCURY: pT = &(MercuryTerms[ltype*6]); break;
-            case VENUS:   pT = &(VenusTerms[ltype*6]);   break;
-            case EARTH:   pT = &(EarthTerms[ltype*6]);   break;
-            case MARS:    pT = &(MarsTerms[ltype*6]);    break;
-            case JUPITER: pT = &(JupiterTerms[ltype*6]); break;
-            case SATURN:  pT = &(SaturnTerms[ltype*6]);  break;
-            case URANUS:  pT = &(UranusTerms[ltype*6]);  break;
-            case NEPTUNE: pT = &(NeptuneTerms[ltype*6]); break;
-            default: break;
-        };
+        const VSOP87Terms* pT = &getTerms( planet, ltype, 0 );
+        const unsigned* counts = hypatia::getLazy<VSOP87Tiers>().count[_precision][planet][ltype];
         
         // Always six series to calculate
         for (int i=0; i<6; i++) {
             double sum = 0.;
             const VSOP87Set* pv = pT->pTerms;
+            const unsigned rows = counts[i];
             
             // sum the term = A x cos( B + C x tc ) for each row
-            for (unsigned j=0; j<pT->rows; j++) {
+            for (unsigned j=0; j<rows; j++) {
                 sum += pv->A * cos( pv->B + pv->C * t );
                 pv++;
             }
@@ -3298,3 +3527,59 @@ double VSOP87::calcLoc(double t,         // time in decimal centuries
     }
     return rval;
 }
+
+/*
+ * Same as calcLoc() also returning the time derivative of the location
+ * element, from the same pass over the tables:
+ *
+ *   d/dt [ A x cos( B + C x t ) x t^i ] = -A x C x sin( B + C x t ) x t^i + i x A x cos( B + C x t ) x t^(i-1)
+ *
+ * The rate is per julian day (radians or AU).
+ */
+void VSOP87::calcLocAndRate(double t,         // time in decimal centuries
+                            BodyId planet,
+                            LocType ltype,
+                            double& _value,
+                            double& _rate) {
+    double rval = 0.0;
+    double rate = 0.0;
+
+    if (planet > SUN && planet < PLUTO && ltype >= 0 && ltype <=2) {
+
+        t /= 10.;          // convert to julian millenia
+        double tPower = 1.0;
+        double tPowerPrev = 0.0;
+
+        const VSOP87Terms* pT = &getTerms( planet, ltype, 0 );
+
+        // Always six series to calculate
+        for (int i=0; i<6; i++) {
+            double sum = 0.;
+            double dsum = 0.;
+            const VSOP87Set* pv = pT->pTerms;
+
+            for (unsigned j=0; j<pT->rows; j++) {
+                double arg = pv->B + pv->C * t;
+                sum += pv->A * cos( arg );
+                dsum -= pv->A * pv->C * sin( arg );
+                pv++;
+            }
+
+            rval += sum * tPower;
+            rate += dsum * tPower + i * sum * tPowerPrev;
+            tPowerPrev = tPower;
+            tPower *= t;
+            pT++;
+        }
+
+        rval *= 1.e-8;  // rescale the term
+        rate *= 1.e-8 / TimeOps::DAYS_PER_MILLENIUM;
+
+        if (ECLIPTIC_LON == ltype) {  /* ensure 0 < rval < 2PI  */
+            rval = MathOps::normalize( rval, RADS );
+        }
+    }
+
+    _value = rval;
+    _rate = rate;
+}
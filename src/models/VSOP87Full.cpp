@@ -0,0 +1,125 @@
+/*****************************************************************************\
+ * VSOP87Full.cpp
+ *
+ * Complete VSOP87 series (version B or D) loaded at runtime.
+ *
+ * Unlike the Meeus tables the amplitudes are stored unscaled (radians and
+ * AU), as in the IMCCE files.
+ *
+\*****************************************************************************/
+
+#include "hypatia/models/VSOP87Full.h"
+
+#include "hypatia/MathOps.h"
+#include "hypatia/models/Exception.h"
+
+#include <string.h>
+
+const uint32_t VSOP87Full::VERSION = 1;
+
+static const char       VSOP_MAGIC[8] = { 'H', 'Y', 'P', 'V', 'S', 'O', 'P', '\0' };
+static const uint32_t   VSOP_ENDIAN = 0x01020304;
+
+VSOP87Full::VSOP87Full() : m_theory(0) {
+}
+
+VSOP87Full::VSOP87Full( const std::string& _filename ) : m_theory(0) {
+    load(_filename);
+}
+
+VSOP87Full::~VSOP87Full() {
+    close();
+}
+
+void VSOP87Full::load( const std::string& _filename ) {
+    close();
+
+    m_file.open(_filename);
+    const char* data = m_file.getData();
+    const size_t size = m_file.getSize();
+
+    const VSOP87FileHeader* header = (const VSOP87FileHeader*)data;
+    if (size < sizeof(VSOP87FileHeader) ||
+        memcmp(header->magic, VSOP_MAGIC, sizeof(VSOP_MAGIC)) != 0 ||
+        header->endian != VSOP_ENDIAN ||
+        header->version != VERSION ||
+        (header->theory != 'B' && header->theory != 'D') ||
+        (uint64_t)header->planets * sizeof(VSOP87FilePlanet) > size - sizeof(VSOP87FileHeader)) {
+        close();
+        throw Exception("Invalid VSOP87 file or version");
+    }
+
+    // Only pointers into the mapping are set up here, no series data is touched
+    const VSOP87FilePlanet* records = (const VSOP87FilePlanet*)(data + sizeof(VSOP87FileHeader));
+    for (uint32_t p = 0; p < header->planets; p++) {
+        const VSOP87FilePlanet& r = records[p];
+
+        // no overflow: at most 18 x 2^32 rows
+        uint64_t total = 0;
+        for (int l = 0; l < 3; l++)
+            for (int i = 0; i < 6; i++)
+                total += r.rows[l][i];
+
+        if (r.id < MERCURY || r.id > NEPTUNE || r.offset % sizeof(double) != 0 ||
+            total * 3 * sizeof(double) > r.bytes || r.offset > size || r.bytes > size - r.offset) {
+            close();
+            throw Exception("Invalid VSOP87 planet record");
+        }
+
+        const double* block = (const double*)(data + r.offset);
+        for (int l = 0; l < 3; l++) {
+            for (int i = 0; i < 6; i++) {
+                unsigned rows = r.rows[l][i];
+                m_series[r.id][l][i] = VSOP87Series( rows, block, block + rows, block + 2 * rows );
+                block += 3 * rows;
+            }
+        }
+    }
+
+    m_theory = header->theory;
+}
+
+void VSOP87Full::close() {
+    m_file.close();
+    m_theory = 0;
+    for (int p = 0; p <= NEPTUNE; p++)
+        for (int l = 0; l < 3; l++)
+            for (int i = 0; i < 6; i++)
+                m_series[p][l][i] = VSOP87Series();
+}
+
+bool VSOP87Full::have( BodyId _planet ) const {
+    if (_planet < MERCURY || _planet > NEPTUNE)
+        return false;
+    return m_series[_planet][VSOP87::RADIUS][0].rows > 0;
+}
+
+const VSOP87Series& VSOP87Full::getSeries( BodyId planet, VSOP87::LocType ltype, int power ) const {
+    static const VSOP87Series empty;
+
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2 || power < 0 || power > 5)
+        return empty;
+
+    return m_series[planet][ltype][power];
+}
+
+double VSOP87Full::calcLoc( double t, BodyId planet, VSOP87::LocType ltype, VSOP87::Kernel _kernel ) const {
+    double rval = 0.0;
+
+    if (planet > SUN && planet < PLUTO && ltype >= 0 && ltype <=2) {
+
+        double tPowers[6];
+        VSOP87::toPowers( t, tPowers );
+
+        // Always six series to calculate
+        for (int i=0; i<6; i++) {
+            // i.e., L = L0*t + L1*t^2 + L2*t^3 + ...
+            rval += VSOP87::sumSeries( m_series[planet][ltype][i], tPowers[1], _kernel ) * tPowers[i];
+        }
+
+        if (VSOP87::ECLIPTIC_LON == ltype) {  /* ensure 0 < rval < 2PI  */
+            rval = MathOps::normalize( rval, RADS );
+        }
+    }
+    return rval;
+}
@@ -0,0 +1,432 @@
+/*****************************************************************************\
+ * VSOP87Simd.cpp
+ *
+ * Structure-of-arrays evaluation engine for the VSOP87 series.
+ *
+ * The Meeus tables are copied once into separate A, B and C arrays so the
+ * sum of A x cos( B + C x t ) can be done several terms at a time. The vector
+ * kernels (AVX2, AVX-512 on x86 and NEON on aarch64) are compiled with
+ * per-function target attributes and the best one is picked at runtime, so
+ * the library itself keeps being built for the baseline instruction set.
+ *
+ * Precision: the vector cosine reduces the argument by PI/2 in three exact
+ * steps (Cody-Waite) and evaluates the Cephes minimax polynomials, giving
+ * <= 2 ulp per term for |B + C x t| <= 1.6e6 rad. Larger arguments (which the
+ * Meeus tables only reach ~70 centuries away from J2000) are summed with
+ * libm cos(). Lanes are summed separately, so the total differs from the
+ * scalar path only by rounding of the (un-normalized) series: < 2e-12 rad/AU
+ * within a century of J2000 and < 1e-10 for |cen| <= 40 centuries.
+ *
+\*****************************************************************************/
+
+#include "hypatia/models/VSOP87.h"
+#include "hypatia/MathOps.h"
+#include "hypatia/TimeOps.h"
+#include "../Lazy.h"
+
+#include <math.h>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VSOP87_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define VSOP87_NEON_KERNEL
+#include <arm_neon.h>
+#endif
+
+// * * * * * structure-of-arrays copy of the tables * * * * *
+
+namespace {
+
+const int N_PLANETS = NEPTUNE + 1;
+
+struct VSOP87SoA {
+    std::vector<double> A, B, C;
+    std::vector<double> dA, dB;     // derivative terms: -A x C and B - PI/2
+    VSOP87Series        series[N_PLANETS][3][6];
+    VSOP87Series        rates[N_PLANETS][3][6];
+
+    VSOP87SoA() {
+        // first pass: reserve so the pointers below stay valid
+        size_t total = 0;
+        for (int p = MERCURY; p <= NEPTUNE; p++)
+            for (int l = 0; l < 3; l++)
+                for (int i = 0; i < 6; i++)
+                    total += VSOP87::getTerms( (BodyId)p, (VSOP87::LocType)l, i ).rows;
+
+        A.reserve(total);
+        B.reserve(total);
+        C.reserve(total);
+        dA.reserve(total);
+        dB.reserve(total);
+
+        for (int p = MERCURY; p <= NEPTUNE; p++) {
+            for (int l = 0; l < 3; l++) {
+                for (int i = 0; i < 6; i++) {
+                    const VSOP87Terms& terms = VSOP87::getTerms( (BodyId)p, (VSOP87::LocType)l, i );
+                    size_t first = A.size();
+                    for (unsigned j = 0; j < terms.rows; j++) {
+                        A.push_back( terms.pTerms[j].A );
+                        B.push_back( terms.pTerms[j].B );
+                        C.push_back( terms.pTerms[j].C );
+                        dA.push_back( -terms.pTerms[j].A * terms.pTerms[j].C );
+                        dB.push_back( terms.pTerms[j].B - MathOps::PI * 0.5 );
+                    }
+                    series[p][l][i] = VSOP87Series( terms.rows, &A[0] + first, &B[0] + first, &C[0] + first );
+                    rates[p][l][i] = VSOP87Series( terms.rows, &dA[0] + first, &dB[0] + first, &C[0] + first );
+                }
+            }
+        }
+    }
+};
+
+// Largest argument the vector cosine reduces exactly ( 2^20 x PI/2 )
+const double COS_MAX_ARG = 1647099.0;
+
+// PI/2 split in three 33 bit pieces (fdlibm), q x PIO2_n is exact for q < 2^20
+const double PIO2_1 = 1.57079632673412561417e+00;
+const double PIO2_2 = 6.07710050630396597660e-11;
+const double PIO2_3 = 2.02226624871116645580e-21;
+
+// Cephes minimax coefficients for sin/cos on [-PI/4, PI/4]
+const double S0 =  1.58962301576546568060e-10;
+const double S1 = -2.50507477628578072866e-8;
+const double S2 =  2.75573136213857245213e-6;
+const double S3 = -1.98412698295895385996e-4;
+const double S4 =  8.33333333332211858878e-3;
+const double S5 = -1.66666666666666307295e-1;
+
+const double C0 = -1.13585365213876817300e-11;
+const double C1 =  2.08757008419747316778e-9;
+const double C2 = -2.75573141792967388112e-7;
+const double C3 =  2.48015872888517045348e-5;
+const double C4 = -1.38888888888730564116e-3;
+const double C5 =  4.16666666666665929218e-2;
+
+double sumScalar(const double* A, const double* B, const double* C, unsigned n, double t) {
+    double sum = 0.;
+    for (unsigned j = 0; j < n; j++)
+        sum += A[j] * cos( B[j] + C[j] * t );
+    return sum;
+}
+
+#ifdef VSOP87_X86_KERNELS
+
+__attribute__((target("avx2")))
+inline __m256d cosAVX2(__m256d x) {
+    const __m256d q = _mm256_round_pd( _mm256_mul_pd(x, _mm256_set1_pd(2.0 / MathOps::PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+
+    __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(q, _mm256_set1_pd(PIO2_1)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(q, _mm256_set1_pd(PIO2_2)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(q, _mm256_set1_pd(PIO2_3)));
+    const __m256d z = _mm256_mul_pd(r, r);
+
+    __m256d s = _mm256_set1_pd(S0);
+    s = _mm256_add_pd(_mm256_mul_pd(s, z), _mm256_set1_pd(S1));
+    s = _mm256_add_pd(_mm256_mul_pd(s, z), _mm256_set1_pd(S2));
+    s = _mm256_add_pd(_mm256_mul_pd(s, z), _mm256_set1_pd(S3));
+    s = _mm256_add_pd(_mm256_mul_pd(s, z), _mm256_set1_pd(S4));
+    s = _mm256_add_pd(_mm256_mul_pd(s, z), _mm256_set1_pd(S5));
+    s = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), s));
+
+    __m256d c = _mm256_set1_pd(C0);
+    c = _mm256_add_pd(_mm256_mul_pd(c, z), _mm256_set1_pd(C1));
+    c = _mm256_add_pd(_mm256_mul_pd(c, z), _mm256_set1_pd(C2));
+    c = _mm256_add_pd(_mm256_mul_pd(c, z), _mm256_set1_pd(C3));
+    c = _mm256_add_pd(_mm256_mul_pd(c, z), _mm256_set1_pd(C4));
+    c = _mm256_add_pd(_mm256_mul_pd(c, z), _mm256_set1_pd(C5));
+    c = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(0.5), z)), _mm256_mul_pd(_mm256_mul_pd(z, z), c));
+
+    // quadrant (0...3): cos = c, -s, -c, s
+    const __m256d n = _mm256_sub_pd(q, _mm256_mul_pd(_mm256_set1_pd(4.0), _mm256_floor_pd(_mm256_mul_pd(q, _mm256_set1_pd(0.25)))));
+    const __m256d odd = _mm256_or_pd(_mm256_cmp_pd(n, _mm256_set1_pd(1.0), _CMP_EQ_OQ), _mm256_cmp_pd(n, _mm256_set1_pd(3.0), _CMP_EQ_OQ));
+    const __m256d neg = _mm256_or_pd(_mm256_cmp_pd(n, _mm256_set1_pd(1.0), _CMP_EQ_OQ), _mm256_cmp_pd(n, _mm256_set1_pd(2.0), _CMP_EQ_OQ));
+
+    const __m256d v = _mm256_blendv_pd(c, s, odd);
+    return _mm256_xor_pd(v, _mm256_and_pd(neg, _mm256_set1_pd(-0.0)));
+}
+
+__attribute__((target("avx2")))
+double sumAVX2(const double* A, const double* B, const double* C, unsigned n, double t) {
+    const __m256d vt = _mm256_set1_pd(t);
+    const __m256d limit = _mm256_set1_pd(COS_MAX_ARG);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d acc = _mm256_setzero_pd();
+    double sum = 0.;
+
+    unsigned j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const __m256d x = _mm256_add_pd(_mm256_loadu_pd(B + j), _mm256_mul_pd(_mm256_loadu_pd(C + j), vt));
+        if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign, x), limit, _CMP_NLE_UQ))) {
+            sum += sumScalar(A + j, B + j, C + j, 4, t);
+            continue;
+        }
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(A + j), cosAVX2(x)));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return sum + sumScalar(A + j, B + j, C + j, n - j, t);
+}
+
+__attribute__((target("avx512f")))
+inline __m512d cosAVX512(__m512d x) {
+    const __m512d q = _mm512_roundscale_pd( _mm512_mul_pd(x, _mm512_set1_pd(2.0 / MathOps::PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC );
+
+    __m512d r = _mm512_sub_pd(x, _mm512_mul_pd(q, _mm512_set1_pd(PIO2_1)));
+    r = _mm512_sub_pd(r, _mm512_mul_pd(q, _mm512_set1_pd(PIO2_2)));
+    r = _mm512_sub_pd(r, _mm512_mul_pd(q, _mm512_set1_pd(PIO2_3)));
+    const __m512d z = _mm512_mul_pd(r, r);
+
+    __m512d s = _mm512_set1_pd(S0);
+    s = _mm512_add_pd(_mm512_mul_pd(s, z), _mm512_set1_pd(S1));
+    s = _mm512_add_pd(_mm512_mul_pd(s, z), _mm512_set1_pd(S2));
+    s = _mm512_add_pd(_mm512_mul_pd(s, z), _mm512_set1_pd(S3));
+    s = _mm512_add_pd(_mm512_mul_pd(s, z), _mm512_set1_pd(S4));
+    s = _mm512_add_pd(_mm512_mul_pd(s, z), _mm512_set1_pd(S5));
+    s = _mm512_add_pd(r, _mm512_mul_pd(_mm512_mul_pd(r, z), s));
+
+    __m512d c = _mm512_set1_pd(C0);
+    c = _mm512_add_pd(_mm512_mul_pd(c, z), _mm512_set1_pd(C1));
+    c = _mm512_add_pd(_mm512_mul_pd(c, z), _mm512_set1_pd(C2));
+    c = _mm512_add_pd(_mm512_mul_pd(c, z), _mm512_set1_pd(C3));
+    c = _mm512_add_pd(_mm512_mul_pd(c, z), _mm512_set1_pd(C4));
+    c = _mm512_add_pd(_mm512_mul_pd(c, z), _mm512_set1_pd(C5));
+    c = _mm512_add_pd(_mm512_sub_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(_mm512_set1_pd(0.5), z)), _mm512_mul_pd(_mm512_mul_pd(z, z), c));
+
+    // quadrant (0...3): cos = c, -s, -c, s
+    const __m512d n = _mm512_sub_pd(q, _mm512_mul_pd(_mm512_set1_pd(4.0), _mm512_roundscale_pd(_mm512_mul_pd(q, _mm512_set1_pd(0.25)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)));
+    const __mmask8 odd = _mm512_cmp_pd_mask(n, _mm512_set1_pd(1.0), _CMP_EQ_OQ) | _mm512_cmp_pd_mask(n, _mm512_set1_pd(3.0), _CMP_EQ_OQ);
+    const __mmask8 neg = _mm512_cmp_pd_mask(n, _mm512_set1_pd(1.0), _CMP_EQ_OQ) | _mm512_cmp_pd_mask(n, _mm512_set1_pd(2.0), _CMP_EQ_OQ);
+
+    const __m512d v = _mm512_mask_blend_pd(odd, c, s);
+    return _mm512_mask_sub_pd(v, neg, _mm512_setzero_pd(), v);
+}
+
+__attribute__((target("avx512f")))
+double sumAVX512(const double* A, const double* B, const double* C, unsigned n, double t) {
+    const __m512d vt = _mm512_set1_pd(t);
+    const __m512d limit = _mm512_set1_pd(COS_MAX_ARG);
+    __m512d acc = _mm512_setzero_pd();
+    double sum = 0.;
+
+    unsigned j = 0;
+    for (; j + 8 <= n; j += 8) {
+        const __m512d x = _mm512_add_pd(_mm512_loadu_pd(B + j), _mm512_mul_pd(_mm512_loadu_pd(C + j), vt));
+        if (_mm512_cmp_pd_mask(_mm512_abs_pd(x), limit, _CMP_NLE_UQ)) {
+            sum += sumScalar(A + j, B + j, C + j, 8, t);
+            continue;
+        }
+        acc = _mm512_add_pd(acc, _mm512_mul_pd(_mm512_loadu_pd(A + j), cosAVX512(x)));
+    }
+
+    double lanes[8];
+    _mm512_storeu_pd(lanes, acc);
+    sum += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    return sum + sumScalar(A + j, B + j, C + j, n - j, t);
+}
+
+#endif
+
+#ifdef VSOP87_NEON_KERNEL
+
+inline float64x2_t cosNEON(float64x2_t x) {
+    const float64x2_t q = vrndnq_f64( vmulq_n_f64(x, 2.0 / MathOps::PI) );
+
+    float64x2_t r = vsubq_f64(x, vmulq_n_f64(q, PIO2_1));
+    r = vsubq_f64(r, vmulq_n_f64(q, PIO2_2));
+    r = vsubq_f64(r, vmulq_n_f64(q, PIO2_3));
+    const float64x2_t z = vmulq_f64(r, r);
+
+    float64x2_t s = vdupq_n_f64(S0);
+    s = vaddq_f64(vmulq_f64(s, z), vdupq_n_f64(S1));
+    s = vaddq_f64(vmulq_f64(s, z), vdupq_n_f64(S2));
+    s = vaddq_f64(vmulq_f64(s, z), vdupq_n_f64(S3));
+    s = vaddq_f64(vmulq_f64(s, z), vdupq_n_f64(S4));
+    s = vaddq_f64(vmulq_f64(s, z), vdupq_n_f64(S5));
+    s = vaddq_f64(r, vmulq_f64(vmulq_f64(r, z), s));
+
+    float64x2_t c = vdupq_n_f64(C0);
+    c = vaddq_f64(vmulq_f64(c, z), vdupq_n_f64(C1));
+    c = vaddq_f64(vmulq_f64(c, z), vdupq_n_f64(C2));
+    c = vaddq_f64(vmulq_f64(c, z), vdupq_n_f64(C3));
+    c = vaddq_f64(vmulq_f64(c, z), vdupq_n_f64(C4));
+    c = vaddq_f64(vmulq_f64(c, z), vdupq_n_f64(C5));
+    c = vaddq_f64(vsubq_f64(vdupq_n_f64(1.0), vmulq_n_f64(z, 0.5)), vmulq_f64(vmulq_f64(z, z), c));
+
+    // quadrant (0...3): cos = c, -s, -c, s
+    const float64x2_t n = vsubq_f64(q, vmulq_n_f64(vrndmq_f64(vmulq_n_f64(q, 0.25)), 4.0));
+    const uint64x2_t odd = vorrq_u64(vceqq_f64(n, vdupq_n_f64(1.0)), vceqq_f64(n, vdupq_n_f64(3.0)));
+    const uint64x2_t neg = vorrq_u64(vceqq_f64(n, vdupq_n_f64(1.0)), vceqq_f64(n, vdupq_n_f64(2.0)));
+
+    const float64x2_t v = vbslq_f64(odd, s, c);
+    return vbslq_f64(neg, vnegq_f64(v), v);
+}
+
+double sumNEON(const double* A, const double* B, const double* C, unsigned n, double t) {
+    const float64x2_t limit = vdupq_n_f64(COS_MAX_ARG);
+    float64x2_t acc = vdupq_n_f64(0.0);
+    double sum = 0.;
+
+    unsigned j = 0;
+    for (; j + 2 <= n; j += 2) {
+        const float64x2_t x = vaddq_f64(vld1q_f64(B + j), vmulq_n_f64(vld1q_f64(C + j), t));
+        const uint64x2_t inRange = vcleq_f64(vabsq_f64(x), limit);
+        if ((vgetq_lane_u64(inRange, 0) & vgetq_lane_u64(inRange, 1)) == 0) {
+            sum += sumScalar(A + j, B + j, C + j, 2, t);
+            continue;
+        }
+        acc = vaddq_f64(acc, vmulq_f64(vld1q_f64(A + j), cosNEON(x)));
+    }
+
+    sum += vgetq_lane_f64(acc, 0) + vgetq_lane_f64(acc, 1);
+    return sum + sumScalar(A + j, B + j, C + j, n - j, t);
+}
+
+#endif
+
+}
+
+// * * * * * runtime dispatch * * * * *
+
+bool VSOP87::isKernelSupported( Kernel _kernel ) {
+    switch ( _kernel ) {
+        case SCALAR: return true;
+#ifdef VSOP87_X86_KERNELS
+        case AVX2:   return __builtin_cpu_supports("avx2");
+        case AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+#ifdef VSOP87_NEON_KERNEL
+        case NEON:   return true;
+#endif
+        default:     return false;
+    }
+}
+
+VSOP87::Kernel VSOP87::getKernel() {
+    static const Kernel best =  isKernelSupported(AVX512)  ? AVX512 :
+                                isKernelSupported(AVX2)    ? AVX2 :
+                                isKernelSupported(NEON)    ? NEON : SCALAR;
+    return best;
+}
+
+const VSOP87Series& VSOP87::getSeries(BodyId planet, LocType ltype, int power) {
+    static const VSOP87Series empty;
+
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2 || power < 0 || power > 5)
+        return empty;
+
+    return hypatia::getLazy<VSOP87SoA>().series[planet][ltype][power];
+}
+
+const VSOP87Series& VSOP87::getRateSeries(BodyId planet, LocType ltype, int power) {
+    static const VSOP87Series empty;
+
+    if (planet <= SUN || planet >= PLUTO || ltype < 0 || ltype > 2 || power < 0 || power > 5)
+        return empty;
+
+    return hypatia::getLazy<VSOP87SoA>().rates[planet][ltype][power];
+}
+
+double VSOP87::sumSeries( const VSOP87Series& _series, double t, Kernel _kernel ) {
+    if ( _series.rows == 0 )
+        return 0.;
+
+    if ( _kernel != SCALAR && !isKernelSupported(_kernel) )
+        _kernel = SCALAR;
+
+    switch ( _kernel ) {
+#ifdef VSOP87_X86_KERNELS
+        case AVX512: return sumAVX512(_series.A, _series.B, _series.C, _series.rows, t);
+        case AVX2:   return sumAVX2(_series.A, _series.B, _series.C, _series.rows, t);
+#endif
+#ifdef VSOP87_NEON_KERNEL
+        case NEON:   return sumNEON(_series.A, _series.B, _series.C, _series.rows, t);
+#endif
+        default:     return sumScalar(_series.A, _series.B, _series.C, _series.rows, t);
+    }
+}
+
+void VSOP87::toPowers( double t, double _tPowers[6] ) {
+    t /= 10.;          // convert to julian millenia
+    double tPower = 1.0;
+    for (int i=0; i<6; i++) {
+        _tPowers[i] = tPower;
+        tPower *= t;
+    }
+}
+
+/*
+ * Same computation as VSOP87::calcLoc() over the structure-of-arrays tables.
+ */
+double VSOP87::calcLocSIMD(double t,
+                           BodyId planet,
+                           LocType ltype,
+                           Kernel _kernel) {
+    double tPowers[6];
+    toPowers( t, tPowers );
+    return calcLocSIMD( tPowers, planet, ltype, _kernel );
+}
+
+double VSOP87::calcLocSIMD(const double _tPowers[6],
+                           BodyId planet,
+                           LocType ltype,
+                           Kernel _kernel) {
+    double rval = 0.0;
+
+    if (planet > SUN && planet < PLUTO && ltype >= 0 && ltype <=2) {
+
+        const double t = _tPowers[1];
+
+        // Always six series to calculate
+        for (int i=0; i<6; i++) {
+            // i.e., L = L0*t + L1*t^2 + L2*t^3 + ...
+            rval += sumSeries( getSeries(planet, ltype, i), t, _kernel ) * _tPowers[i];
+        }
+
+        rval *= 1.e-8;  // rescale the term
+
+        if (ECLIPTIC_LON == ltype) {  /* ensure 0 < rval < 2PI  */
+            rval = MathOps::normalize( rval, RADS );
+        }
+    }
+    return rval;
+}
+
+void VSOP87::calcLocAndRateSIMD(const double _tPowers[6],
+                                BodyId planet,
+                                LocType ltype,
+                                double& _value,
+                                double& _rate,
+                                Kernel _kernel) {
+    double rval = 0.0;
+    double rate = 0.0;
+
+    if (planet > SUN && planet < PLUTO && ltype >= 0 && ltype <=2) {
+
+        const double t = _tPowers[1];
+
+        for (int i=0; i<6; i++) {
+            double sum = sumSeries( getSeries(planet, ltype, i), t, _kernel );
+            double dsum = sumSeries( getRateSeries(planet, ltype, i), t, _kernel );
+            rval += sum * _tPowers[i];
+            rate += dsum * _tPowers[i];
+            if (i > 0)
+                rate += i * sum * _tPowers[i-1];
+        }
+
+        rval *= 1.e-8;  // rescale the term
+        rate *= 1.e-8 / TimeOps::DAYS_PER_MILLENIUM;
+
+        if (ECLIPTIC_LON == ltype) {  /* ensure 0 < rval < 2PI  */
+            rval = MathOps::normalize( rval, RADS );
+        }
+    }
+
+    _value = rval;
+    _rate = rate;
+}
@@ -0,0 +1,106 @@
+/*****************************************************************************\
+ * VSOP87Sweep.cpp
+ *
+ * Evaluation of the VSOP87 series at uniformly spaced times.
+ *
+ * For t_k = t_0 + k x dt every term's argument advances by the constant
+ * angle C x dt, so
+ *
+ *   cos( B + C x t_(k+1) ) = cos( B + C x t_k ) x cos( C x dt ) - sin( B + C x t_k ) x sin( C x dt )
+ *   sin( B + C x t_(k+1) ) = sin( B + C x t_k ) x cos( C x dt ) + cos( B + C x t_k ) x sin( C x dt )
+ *
+ * and a step only costs a few multiply-adds per term. Each rotation adds
+ * about one ulp of error to the cos/sin pair, so the state is re-seeded
+ * with libm cos()/sin() periodically to keep the drift bounded.
+ *
+\*****************************************************************************/
+
+#include "hypatia/models/VSOP87.h"
+#include "hypatia/MathOps.h"
+
+#include <math.h>
+#include <vector>
+
+void VSOP87::sweep( BodyId planet, double cen0, double dcen, unsigned n, double* _out, unsigned _reseed ) {
+    if (n == 0)
+        return;
+
+    if (planet <= SUN || planet >= PLUTO) {
+        for (unsigned k = 0; k < 3 * n; k++)
+            _out[k] = 0.0;
+        return;
+    }
+
+    if (_reseed == 0)
+        _reseed = 1;
+
+    // gather the 18 series ( 3 locations x 6 powers ) of this body
+    const VSOP87Series* series[3][6];
+    unsigned first[3][6];
+    unsigned total = 0;
+    for (int l = 0; l < 3; l++) {
+        for (int i = 0; i < 6; i++) {
+            series[l][i] = &getSeries( planet, (LocType)l, i );
+            first[l][i] = total;
+            total += series[l][i]->rows;
+        }
+    }
+
+    // per term state: amplitude, current cos/sin and the rotation for one step
+    std::vector<double> A(total), B(total), C(total), cs(total), sn(total), rc(total), rs(total);
+    const double dt = dcen / 10.;       // julian millenia
+    for (int l = 0; l < 3; l++) {
+        for (int i = 0; i < 6; i++) {
+            const VSOP87Series& s = *series[l][i];
+            for (unsigned j = 0; j < s.rows; j++) {
+                unsigned m = first[l][i] + j;
+                A[m] = s.A[j];
+                B[m] = s.B[j];
+                C[m] = s.C[j];
+                rc[m] = cos( s.C[j] * dt );
+                rs[m] = sin( s.C[j] * dt );
+            }
+        }
+    }
+
+    double tPowers[6];
+    for (unsigned k = 0; k < n; k++) {
+        double cen = cen0 + k * dcen;
+
+        if (k % _reseed == 0) {
+            const double t = cen / 10.;
+            for (unsigned m = 0; m < total; m++) {
+                double arg = B[m] + C[m] * t;
+                cs[m] = cos( arg );
+                sn[m] = sin( arg );
+            }
+        }
+
+        toPowers( cen, tPowers );
+        for (int l = 0; l < 3; l++) {
+            double rval = 0.0;
+            for (int i = 0; i < 6; i++) {
+                double sum = 0.;
+                const unsigned end = first[l][i] + series[l][i]->rows;
+                for (unsigned m = first[l][i]; m < end; m++)
+                    sum += A[m] * cs[m];
+                rval += sum * tPowers[i];
+            }
+
+            rval *= 1.e-8;  // rescale the term
+
+            if (ECLIPTIC_LON == l) {  /* ensure 0 < rval < 2PI  */
+                rval = MathOps::normalize( rval, RADS );
+            }
+            _out[3 * k + l] = rval;
+        }
+
+        // advance every term to the next step
+        for (unsigned m = 0; m < total; m++) {
+            double c = cs[m];
+            double s = sn[m];
+            cs[m] = c * rc[m] - s * rs[m];
+            sn[m] = s * rc[m] + c * rs[m];
+        }
+    }
+}
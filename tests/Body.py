@@ -80,6 +80,105 @@ tests = [
   test(Body(PLUTO), ephem.Pluto(e_obs))
 ]
 
+# Rise, transit and set times against ephem's next_rising / next_transit / next_setting
+# ephem's default horizon (0° for the upper limb, with refraction) matches EventOps.getHorizon()
+#
+EVENT_TOLERANCE_MIN = { SUN: 2.0, LUNA: 5.0 }
+
+def testEvents(a_body, e_body, lng, lat, date):
+  a_obs = Observer(lng, lat)
+  e_obs = ephem.Observer()
+  e_obs.lon = MathOps.toRadians(lng)
+  e_obs.lat = MathOps.toRadians(lat)
+  e_obs.elevation = 0
+  e_obs.date = date
+
+  jd0 = ephem.julian_date(e_obs.date)
+  events = EventOps.findEvents(a_body, a_obs, jd0, jd0 + 2.0, EventOps.getHorizon(a_body.getId()))
+  tolerance = EVENT_TOLERANCE_MIN[a_body.getId()]
+
+  print( "[ " + a_body.getName() + " events at " + str(lat) + "°, " + date + " ]")
+  ok = True
+
+  for (name, event_type, next_event) in [ ('rise', RISE, e_obs.next_rising), ('transit', TRANSIT, e_obs.next_transit), ('set', SET, e_obs.next_setting) ]:
+    a_jd = None
+    for i in range(0, len(events)):
+      if events[i].type == event_type:
+        a_jd = events[i].jd
+        break
+
+    try:
+      e_jd = ephem.julian_date(next_event(e_body))
+    except (ephem.AlwaysUpError, ephem.NeverUpError):
+      e_jd = None
+
+    if e_jd == None or e_jd > jd0 + 1.0:
+      # circumpolar, never up or not in the next day: none in the next day either
+      if a_jd != None and a_jd < jd0 + 1.0 - tolerance / 1440.0:
+        print('UNEXPECTED %s at %s' % (name, a_jd))
+        ok = False
+    elif a_jd == None:
+      print('MISSING %s at %s' % (name, e_jd))
+      ok = False
+    elif abs(a_jd - e_jd) * 1440.0 > tolerance:
+      print('DELTA %s: %s min' % (name, abs(a_jd - e_jd) * 1440.0))
+      ok = False
+
+  return ok
+
+POLAR_LNG = 18.9553
+POLAR_LAT = 69.6492
+
+tests += [
+  testEvents(Body(SUN), ephem.Sun(), LNG, LAT, '2021/03/20 00:00'),
+  testEvents(Body(LUNA), ephem.Moon(), LNG, LAT, '2021/03/20 00:00'),
+  testEvents(Body(SUN), ephem.Sun(), POLAR_LNG, POLAR_LAT, '2021/06/21 00:00'),     # midnight sun
+  testEvents(Body(SUN), ephem.Sun(), POLAR_LNG, POLAR_LAT, '2021/12/21 00:00'),     # polar night
+  testEvents(Body(LUNA), ephem.Moon(), POLAR_LNG, POLAR_LAT, '2021/12/21 00:00')
+]
+
+# computeRange() against compute() at every sample
+#
+RANGE_TOLERANCE_RAD = 1e-9
+ISS = TLE('ISS (ZARYA)',
+          '1 25544U 98067A   21078.53567130  .00001238  00000-0  30722-4 0  9990',
+          '2 25544  51.6441  58.4451 0003267 132.8627 348.9296 15.48952051274805')
+
+def testRange(a_body, jd_start, jd_end, step, make_body):
+  a_obs = Observer(LNG, LAT)
+  samples = a_body.computeRange(a_obs, jd_start, jd_end, step)
+  print( "[ " + a_body.getName() + " range of " + str(len(samples)) + " ]")
+  ok = len(samples) == Body.getRangeSize(jd_start, jd_end, step)
+
+  for s in samples:
+    a_obs.setJD(s.jd)
+    body = make_body()
+    body.compute(a_obs)
+    for (name, a, b) in [ ('ra', s.ra, body.getEquatorial().getRightAscension(RADS)),
+                          ('dec', s.dec, body.getEquatorial().getDeclination(RADS)),
+                          ('alt', s.alt, body.getHorizontal().getAltitud(RADS)),
+                          ('az', s.az, body.getHorizontal().getAzimuth(RADS)) ]:
+      d = abs((a - b + math.pi) % (2.0 * math.pi) - math.pi)
+      if d > RANGE_TOLERANCE_RAD:
+        print('DELTA %s at %s: %s rad' % (name, s.jd, d))
+        ok = False
+  return ok
+
+JD_RANGE = 2459293.5
+
+tests += [
+  testRange(Body(MARS), JD_RANGE, JD_RANGE + 30.0, 0.25, lambda: Body(MARS)),
+  testRange(Body(LUNA), JD_RANGE, JD_RANGE + 2.0, 1.0 / 24.0, lambda: Body(LUNA)),
+  testRange(Body(PLUTO), JD_RANGE, JD_RANGE + 10.0, 1.0, lambda: Body(PLUTO)),
+  testRange(Satellite(ISS), JD_RANGE, JD_RANGE + 0.1, 1.0 / 1440.0, lambda: Satellite(ISS)),
+  len(Body().computeRange(Observer(LNG, LAT), JD_RANGE, JD_RANGE + 1.0, 0.1)) == 0
+]
+
+# ranges ending on a step include their end, whatever the rounding of the julian days
+for step in [ 1.0 / 86400.0, 1.0 / 1440.0, 1.0 / 24.0 ]:
+  for k in range(1, 50):
+    tests.append( Body.getRangeSize(JD_RANGE + k * 0.37, JD_RANGE + k * 0.37 + k * step, step) == k + 1 )
+
 check = True
 for i in range(0, len(tests)):
   if not tests[i]:
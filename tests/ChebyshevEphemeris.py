@@ -0,0 +1,101 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import os
+import random
+import struct
+import tempfile
+
+from hypatia import *
+
+# ChebyshevEphemeris build -> load -> eval round trip against the models
+
+random.seed(3)
+
+J2000 = 2451545.0
+
+HEADER_SIZE = 40    # sizeof(ChebyshevHeader)
+RECORD_SIZE = 40    # sizeof(ChebyshevBody)
+
+# relative tolerance per body, see include/hypatia/models/ChebyshevEphemeris.h
+TOLERANCE = { PLUTO: 1e-7, LUNA: 1e-9 }
+BODIES = [ MERCURY, VENUS, EARTH, MARS, JUPITER, SATURN, URANUS, NEPTUNE, PLUTO, LUNA ]
+
+def model(body_id, jd):
+  body = Body(body_id)
+  body.compute(Observer(jd))
+  if body_id == LUNA:
+    return body.getEclipticGeocentric().getVector(AU)
+  return body.getEclipticHeliocentric().getVector(AU)
+
+def testBody(eph, body_id, jds):
+  tolerance = TOLERANCE.get(body_id, 1e-10)
+  for jd in jds:
+    a = eph.getGeocentricVector(body_id, jd) if body_id == LUNA else eph.getHeliocentricVector(body_id, jd)
+    b = model(body_id, jd)
+    d = (a - b).getMagnitud() / b.getMagnitud()
+    if d > tolerance:
+      print( "[FAIL] body", body_id, "at", jd, "relative error", d )
+      return False
+  return True
+
+def rejects(filename, data):
+  with open(filename, 'wb') as f:
+    f.write(data)
+  try:
+    ChebyshevEphemeris(filename)
+  except RuntimeError:
+    return True
+  print( "[FAIL] accepted a corrupt file" )
+  return False
+
+(fd, filename) = tempfile.mkstemp(suffix='.bin')
+os.close(fd)
+(fd, corrupt) = tempfile.mkstemp(suffix='.bin')
+os.close(fd)
+
+# across J2000, where Luna's series jump
+jd_start = J2000 - 100.3
+jd_end = J2000 + 60.2
+ChebyshevEphemeris.build(filename, jd_start, jd_end)
+eph = ChebyshevEphemeris(filename)
+
+jds = [ jd_start, jd_end, J2000, J2000 - 1e-6 ] + [ random.uniform(jd_start, jd_end) for i in range(0, 50) ]
+tests = [ eph.getJDStart() == jd_start, eph.getJDEnd() == jd_end ]
+for body_id in BODIES:
+  tests.append( testBody(eph, body_id, jds) )
+eph.close()
+
+with open(filename, 'rb') as f:
+  data = f.read()
+
+def patch(offset, fmt, value):
+  return data[:offset] + struct.pack(fmt, value) + data[offset + struct.calcsize(fmt):]
+
+tests += [
+  rejects(corrupt, data[:len(data) - 8]),                                               # truncated
+  rejects(corrupt, data[:HEADER_SIZE + RECORD_SIZE]),                                   # truncated records
+  rejects(corrupt, patch(0, '8s', b'HYPXXXX\0')),                                       # magic
+  rejects(corrupt, patch(HEADER_SIZE + 2 * RECORD_SIZE + 4, '=I', 0xFFFFFFFF)),         # degree
+  rejects(corrupt, patch(HEADER_SIZE + 2 * RECORD_SIZE + 32, '=Q', 0xFFFFFFFFFFFFFF00)),# offset
+  rejects(corrupt, patch(HEADER_SIZE + 2 * RECORD_SIZE + 8, '=I', 1))                   # intervals short of the range
+]
+
+os.remove(filename)
+os.remove(corrupt)
+
+check = True
+for i in range(0, len(tests)):
+  if not tests[i]:
+    check = False
+    print("Test number",str(i), "fail")
+
+if not check:
+  print(__file__, "FAILURE")
+else:
+  print(__file__, "SUCESS")
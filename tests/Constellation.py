@@ -0,0 +1,86 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import math
+import random
+
+from hypatia import *
+
+# Constellation.classify() (lookup raster) against Constellation.lookup() (search of the boundary table)
+
+random.seed(21)
+
+def testPoints(ras, decs, name):
+  expected = [ Constellation.lookup(ras[i], decs[i]) for i in range(0, len(ras)) ]
+  single = [ Constellation.classify(ras[i], decs[i]) for i in range(0, len(ras)) ]
+  batch = list(Constellation.classify(ras, decs))
+
+  check = True
+  for i in range(0, len(ras)):
+    if single[i] != expected[i] or batch[i] != expected[i]:
+      print( "[FAIL]", name, "at", ras[i], decs[i], ":", single[i], batch[i], "expected", expected[i] )
+      check = False
+      break
+  return check
+
+# uniform over the sphere
+ras = [ random.uniform(0., 360.) for i in range(0, 20000) ]
+decs = [ MathOps.toDegrees(math.asin(random.uniform(-1., 1.))) for i in range(0, 20000) ]
+random_points = testPoints(ras, decs, "random")
+
+# right on and around the boundary vertices, where the raster falls back to the search
+ras = []
+decs = []
+id = 0
+while Constellation(id).getId() == id:
+  for vertex in Constellation(id).getBoundary():
+    for d in [ -1e-6, 0., 1e-6, 0.01 ]:
+      ras.append( MathOps.normalize(vertex.getRightAscension(DEGS) + d, DEGS) )
+      decs.append( max(-90., min(89.999999, vertex.getDeclination(DEGS) - d)) )
+  id += 1
+boundary_points = testPoints(ras, decs, "boundary")
+
+# on the edges of the raster cells (0.25 degrees) and on the edges of the raster itself
+ras = []
+decs = []
+for i in range(0, 5000):
+  ras.append( random.randint(0, 1439) * 0.25 )
+  decs.append( random.randint(-360, 359) * 0.25 )
+for (ra, dec) in [ (0., -90.), (0., 89.99), (359.999999, 0.), (360., 0.), (-0.5, 10.), (10., 90.), (10., -90.5) ]:
+  ras.append(ra)
+  decs.append(dec)
+edge_points = testPoints(ras, decs, "edges")
+
+# threads and epochs: the epoch variants have their own name, so a thread count is never taken for an epoch
+ras = [ random.uniform(0., 360.) for i in range(0, 2000) ]
+decs = [ MathOps.toDegrees(math.asin(random.uniform(-1., 1.))) for i in range(0, 2000) ]
+batch = list(Constellation.classify(ras, decs))
+threads = list(Constellation.classify(ras, decs, 2)) == batch
+boundary_epoch = list(Constellation.classifyAtEpoch(ras, decs, 1875.0)) == batch
+j2000 = list(Constellation.classifyAtEpoch(ras, decs, 2000.0, 2)) == [ Constellation.classifyAtEpoch(Equatorial(ras[i], decs[i], DEGS), 2000.0) for i in range(0, len(ras)) ]
+
+tests = [
+  random_points,
+  boundary_points,
+  edge_points,
+  threads,
+  boundary_epoch,
+  j2000,
+  Constellation.classify(83.8, -5.4) == Constellation("Ori").getId()
+]
+
+check = True
+for i in range(0, len(tests)):
+  if not tests[i]:
+    check = False
+    print("Test number",str(i), "fail")
+
+if not check:
+  print(__file__, "FAILURE")
+else:
+  print(__file__, "SUCESS")
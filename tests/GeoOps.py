@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import math
+import random
+
+from hypatia import *
+
+# GeoOps city searches (city grid) against a scan of every city
+
+random.seed(24)
+
+# index 0 is "unknown", not a city
+cities = 1
+while GeoOps.getCityName(cities) != "unknown":
+  cities += 1
+
+lngs = [ GeoOps.getCityLongitude(i) for i in range(0, cities) ]
+lats = [ GeoOps.getCityLatitude(i) for i in range(0, cities) ]
+
+# (distance, index) of every city, closest first (ties by index)
+def scan(lng, lat):
+  return sorted([ (GeoOps.distance(lng, lat, lngs[i], lats[i]), i) for i in range(1, cities) ])
+
+def testClosest(lng, lat, k, radius_km):
+  by_distance = scan(lng, lat)
+  check = True
+
+  expected = by_distance[0][1] if by_distance[0][0] < 50.0 else 0
+  got = GeoOps.findClosestCity(lng, lat)
+  if got != expected:
+    print( "[FAIL] findClosestCity(", lng, lat, ") is", got, "expected", expected )
+    check = False
+
+  expected = [ c[1] for c in by_distance[0:k] ]
+  got = list(GeoOps.findClosestCities(lng, lat, k))
+  if got != expected:
+    print( "[FAIL] findClosestCities(", lng, lat, k, ") is", got, "expected", expected )
+    check = False
+
+  expected = [ c[1] for c in by_distance if c[0] <= radius_km ]
+  got = list(GeoOps.findCitiesWithin(lng, lat, radius_km))
+  if got != expected:
+    print( "[FAIL] findCitiesWithin(", lng, lat, radius_km, ") has", len(got), "cities, expected", len(expected) )
+    check = False
+
+  return check
+
+points = [ (0., 90.), (0., -89.95), (179.99, 0.), (-180., 45.) ]
+for i in range(0, 60):
+  if i % 2:
+    # around a city
+    c = random.randint(1, cities - 1)
+    points.append( (lngs[c] + random.uniform(-0.5, 0.5), max(-90., min(90., lats[c] + random.uniform(-0.5, 0.5)))) )
+  else:
+    points.append( (random.uniform(-180., 180.), MathOps.toDegrees(math.asin(random.uniform(-1., 1.)))) )
+
+tests = []
+for i in range(0, len(points)):
+  tests.append( testClosest(points[i][0], points[i][1], 1 + i % 37, 700.0 if i % 3 == 0 else 100.0) )
+
+# batches are the same as one location at a time
+locations = [ Geodetic(p[0], p[1], 0.0, DEGS, KM) for p in points ]
+tests.append( list(GeoOps.findClosestCity(locations)) == [ GeoOps.findClosestCity(p[0], p[1]) for p in points ] )
+
+# more than there are: every city
+tests.append( len(GeoOps.findClosestCities(0., 0., cities + 5)) == cities - 1 )
+
+check = True
+for i in range(0, len(tests)):
+  if not tests[i]:
+    check = False
+    print("Test number",str(i), "fail")
+
+if not check:
+  print(__file__, "FAILURE")
+else:
+  print(__file__, "SUCESS")
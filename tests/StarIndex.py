@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import math
+import random
+
+from hypatia import *
+
+# StarIndex queries against a scan of the whole catalog
+
+random.seed(3)
+
+def toTuple(v):
+  return (v.x, v.y, v.z)
+
+def dot(a, b):
+  return a[0]*b[0] + a[1]*b[1] + a[2]*b[2]
+
+def cross(a, b):
+  return (a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2], a[0]*b[1] - a[1]*b[0])
+
+def normalize(a):
+  l = math.sqrt(dot(a, a))
+  return (a[0]/l, a[1]/l, a[2]/l)
+
+catalog = []
+while True:
+  star = Star(len(catalog))
+  if star.getId() < 0:
+    break
+  catalog.append( (toTuple(star.getEquatorial().getVector()), star.getMagnitud()) )
+
+def brightestFirst(ids):
+  for i in range(1, len(ids)):
+    if catalog[ids[i]][1] < catalog[ids[i-1]][1]:
+      return False
+  return True
+
+# magnitude limit None keeps every star (StarIndex::MAG_ALL)
+def testCone(ra, dec, radius, mag):
+  center = Equatorial(ra, dec, DEGS)
+  if mag == None:
+    got = list(StarIndex.starsInCone(center, radius, DEGS))
+  else:
+    got = list(StarIndex.starsInCone(center, radius, DEGS, mag))
+
+  c = toTuple(center.getVector())
+  cosRadius = math.cos(MathOps.toRadians(radius))
+  expected = [ i for i in range(0, len(catalog)) if (mag == None or catalog[i][1] <= mag) and dot(c, catalog[i][0]) >= cosRadius ]
+
+  check = sorted(got) == expected and brightestFirst(got)
+  if not check:
+    print( "[FAIL] cone at", ra, dec, "radius", radius, "mag", mag, ":", len(got), "stars, expected", len(expected) )
+  return check
+
+def testSquare(ra, dec, half, reverse):
+  # square field of view of half side 'half' degrees on the tangent plane at ra, dec
+  c = toTuple(Equatorial(ra, dec, DEGS).getVector())
+  e = cross((0., 0., 1.), c)
+  e = normalize(e) if dot(e, e) > 0. else (1., 0., 0.)
+  n = cross(c, e)
+  t = math.tan(MathOps.toRadians(half))
+
+  corners = [ (1, 1), (-1, 1), (-1, -1), (1, -1) ]
+  if reverse:
+    corners.reverse()
+  vertices = [ normalize(tuple(c[k] + e[k]*t*sx + n[k]*t*sy for k in range(3))) for (sx, sy) in corners ]
+
+  got = list(StarIndex.starsInPolygon([ Equatorial(Vector3(v[0], v[1], v[2])) for v in vertices ]))
+
+  normals = []
+  for k in range(0, 4):
+    m = cross(vertices[k], vertices[(k + 1) % 4])
+    if dot(m, c) < 0.:
+      m = (-m[0], -m[1], -m[2])
+    normals.append(m)
+  expected = [ i for i in range(0, len(catalog)) if all(dot(m, catalog[i][0]) >= 0. for m in normals) ]
+
+  check = sorted(got) == expected and brightestFirst(got)
+  if not check:
+    print( "[FAIL] field at", ra, dec, "half side", half, ":", len(got), "stars, expected", len(expected) )
+  return check
+
+tests = [
+  testCone(0., 90., 10., None),
+  testCone(180., -89.5, 5., None),
+  testCone(10., 0., 180., None),
+  testCone(83.8, -5.4, 12., 4.5)
+]
+
+for i in range(0, 200):
+  ra = random.uniform(0., 360.)
+  dec = MathOps.toDegrees(math.asin(random.uniform(-1., 1.)))
+  radius = random.uniform(0., 120.) if i % 10 == 0 else random.uniform(0., 8.)
+  mag = 4.5 if i % 3 == 0 else None
+  tests.append( testCone(ra, dec, radius, mag) )
+
+for i in range(0, 100):
+  ra = random.uniform(0., 360.)
+  dec = MathOps.toDegrees(math.asin(random.uniform(-1., 1.)))
+  tests.append( testSquare(ra, dec, random.uniform(0.5, 20.), i % 2 == 1) )
+
+check = True
+for i in range(0, len(tests)):
+  if not tests[i]:
+    check = False
+    print("Test number",str(i), "fail")
+
+if not check:
+  print(__file__, "FAILURE")
+else:
+  print(__file__, "SUCESS")
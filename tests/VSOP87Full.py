@@ -0,0 +1,118 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import math
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+from hypatia import *
+
+# data/create_vsop87.py and VSOP87Full on small synthetic series, against a direct sum
+
+random.seed(7)
+
+HEADER_SIZE = 24    # sizeof(VSOP87FileHeader)
+RECORD_SIZE = 96    # sizeof(VSOP87FilePlanet)
+
+NAMES = { MERCURY: ('mer', 'MERCURY'), MARS: ('mar', 'MARS') }
+
+# series[variable][power] = [ (A, B, C), ... ]
+def randomSeries():
+  return [ [ [ (random.uniform(-1., 1.) * 10.**-p, random.uniform(0., 2. * math.pi), random.uniform(0., 8000.))
+              for i in range(0, random.randint(0 if p > 0 else 1, 6)) ]
+            for p in range(0, 6) ]
+          for v in range(0, 3) ]
+
+# in the layout of the IMCCE files: a header line per series, A, B and C in the last three columns
+def writeSeries(folder, body_id, series):
+  (ext, name) = NAMES[body_id]
+  with open(os.path.join(folder, 'VSOP87D.' + ext), 'w') as f:
+    for v in range(0, 3):
+      for p in range(0, 6):
+        f.write(' VSOP87 VERSION D1    %s   VARIABLE %d (LBR)       *T**%d    %5d TERMS    HELIOCENTRIC DYNAMICAL ECLIPTIC AND EQUINOX OF THE DATE\n' % (name, v + 1, p, len(series[v][p])))
+        for i in range(0, len(series[v][p])):
+          (a, b, c) = series[v][p][i]
+          f.write(' %d%d%d%5d  0  0  0  0  0  0  0  0  0  0  0  0 %r %r %r\n' % (4, v + 1, p, i + 1, a, b, c))
+
+# cen in julian centuries, the series are in julian millenia
+def directSum(series, v, cen):
+  t = cen / 10.
+  value = 0.
+  for p in range(0, 6):
+    value += sum([ a * math.cos(b + c * t) for (a, b, c) in series[v][p] ]) * t**p
+  if v == 0:
+    value = value % (2. * math.pi)
+  return value
+
+def rejects(filename, data):
+  with open(filename, 'wb') as f:
+    f.write(data)
+  try:
+    VSOP87Full(filename)
+  except RuntimeError:
+    return True
+  print( "[FAIL] accepted a corrupt file" )
+  return False
+
+folder = tempfile.mkdtemp()
+filename = os.path.join(folder, 'vsop87d.bin')
+corrupt = os.path.join(folder, 'corrupt.bin')
+
+series = { MERCURY: randomSeries(), MARS: randomSeries() }
+for body_id in series:
+  writeSeries(folder, body_id, series[body_id])
+
+script = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'data', 'create_vsop87.py')
+subprocess.check_call([ sys.executable, script, folder, filename ])
+
+vsop = VSOP87Full(filename)
+tests = [ vsop.getTheory() == 'D', vsop.have(MERCURY), vsop.have(MARS), not vsop.have(VENUS) ]
+
+for body_id in series:
+  for t in [ 0., 1e-3, -0.25, 0.5, random.uniform(-1., 1.) ]:
+    (lon, lat, rad) = vsop.calcAllLocs(t, body_id)
+    expected = [ directSum(series[body_id], v, t) for v in range(0, 3) ]
+    d_lon = abs(lon - expected[0])
+    d = max([ min(d_lon, 2. * math.pi - d_lon), abs(lat - expected[1]), abs(rad - expected[2]) ])
+    if d > 1e-11:
+      print( "[FAIL] body", body_id, "at", t, ":", (lon, lat, rad), "expected", expected )
+    tests.append( d <= 1e-11 )
+vsop.close()
+
+with open(filename, 'rb') as f:
+  data = f.read()
+
+def patch(offset, fmt, value):
+  return data[:offset] + struct.pack(fmt, value) + data[offset + struct.calcsize(fmt):]
+
+tests += [
+  rejects(corrupt, data[:len(data) - 8]),                                       # truncated
+  rejects(corrupt, data[:HEADER_SIZE + RECORD_SIZE]),                           # truncated records
+  rejects(corrupt, patch(0, '8s', b'HYPXXXX\0')),                               # magic
+  rejects(corrupt, patch(20, 'c', b'A')),                                       # theory
+  rejects(corrupt, patch(HEADER_SIZE + 80, '<Q', 0xFFFFFFFFFFFFF000)),          # offset past the end (wraps when added to the size)
+  rejects(corrupt, patch(HEADER_SIZE + 4, '<I', 0x7FFFFFFF))                    # more rows than the block holds
+]
+
+shutil.rmtree(folder)
+
+check = True
+for i in range(0, len(tests)):
+  if not tests[i]:
+    check = False
+    print("Test number",str(i), "fail")
+
+if not check:
+  print(__file__, "FAILURE")
+else:
+  print(__file__, "SUCESS")